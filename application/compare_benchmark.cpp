@@ -0,0 +1,91 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <functional>
+#include "fs.h"
+#include "comparator.h"
+#include "compare_kernel.h"
+
+// Measures throughput of output comparison: operator>> used by old 't' command
+// against streaming comparator with every compare kernel supported by CPU
+int main(int argc, char *argv[]) {
+    size_t size_mb = 256;
+    if (argc > 2) {
+        std::cerr << "Usage: compare_benchmark [size in MB]" << std::endl;
+        return 1;
+    }
+    if (argc == 2)
+        size_mb = std::stoul(argv[1]);
+
+    fs::path result_path = fs::temp_directory_path() / "comproenv_benchmark_result.txt";
+    fs::path expected_path = fs::temp_directory_path() / "comproenv_benchmark_expected.txt";
+    {
+        std::ofstream result(result_path, std::ios::binary), expected(expected_path, std::ios::binary);
+        if (!result.is_open() || !expected.is_open()) {
+            std::cerr << "Unable to create files in " << fs::temp_directory_path() << std::endl;
+            return 1;
+        }
+        std::mt19937 rng(42);
+        std::string line;
+        size_t written = 0;
+        while (written < size_mb * 1024 * 1024) {
+            line.clear();
+            for (int i = 0; i < 10; ++i) {
+                if (i)
+                    line.push_back(' ');
+                line += std::to_string(rng() % 1000000000);
+            }
+            line.push_back('\n');
+            result << line;
+            expected << line;
+            written += line.size();
+        }
+    }
+    double size_gb = (double)fs::file_size(result_path) / (1024.0 * 1024.0 * 1024.0);
+
+    auto measure = [&](const std::string &name, const std::function<bool()> &compare) {
+        auto time_start = std::chrono::steady_clock::now();
+        bool equal = compare();
+        auto time_finish = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(time_finish - time_start).count();
+        std::cout << name << ": " << seconds << " s, " << size_gb / seconds << " GB/s" <<
+            (equal ? "" : " (files differ!)") << std::endl;
+    };
+
+    measure("operator>> into vectors", [&]() {
+        std::vector <std::string> res_in, res_out;
+        std::string buf;
+        std::ifstream f(result_path);
+        while (f >> buf)
+            res_in.emplace_back(buf);
+        f.close();
+        f.open(expected_path);
+        while (f >> buf)
+            res_out.emplace_back(buf);
+        return res_in == res_out;
+    });
+    measure("operator>> token by token", [&]() {
+        std::ifstream result(result_path), expected(expected_path);
+        std::string a, b;
+        while (true) {
+            bool has_a = (bool)(result >> a), has_b = (bool)(expected >> b);
+            if (has_a != has_b || (has_a && a != b))
+                return false;
+            if (!has_a)
+                return true;
+        }
+    });
+    for (const auto &kernel : comproenv::CompareKernel::get_available()) {
+        comproenv::CompareKernel::select(kernel);
+        measure("TokenComparator (" + kernel + ")", [&]() {
+            return comproenv::TokenComparator::compare(result_path.string(), expected_path.string()).equal;
+        });
+    }
+
+    fs::remove(result_path);
+    fs::remove(expected_path);
+    return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef INCLUDE_CHECKER_H
+#define INCLUDE_CHECKER_H
+#include <string>
+#include <memory>
+#include "checker_plugin.h"
+
+namespace comproenv {
+
+// Read-only view of a whole file: mapped into memory if possible
+class MappedFile {
+ private:
+    const char *data;
+    size_t size;
+    bool mapped;
+    std::string content;
+ public:
+    MappedFile(const std::string &path);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+    // Missing file is viewed as an empty one
+    comproenv_buffer get_buffer() const;
+};
+
+// In-process checker which is called through the plugin C ABI, built-in
+// checkers (tokens, float, hash) are implemented through the same interface
+class Checker {
+ public:
+    struct Result {
+        comproenv_verdict verdict = COMPROENV_OK;
+        std::string message;
+    };
+ private:
+    comproenv_check_function function;
+    std::string arguments;
+    void *library;
+    Checker(comproenv_check_function check_function, const std::string &check_arguments, void *library_handle);
+ public:
+    Checker(const Checker &) = delete;
+    Checker &operator=(const Checker &) = delete;
+    ~Checker();
+    // Built-in checkers: "tokens", "float:<epsilon>" and "hash", nullptr for unknown names
+    static std::unique_ptr <Checker> create_builtin(const std::string &name);
+    // Loads shared library that exports comproenv_check, error is set on failure
+    static std::unique_ptr <Checker> load_plugin(const std::string &path, std::string &error);
+    // File name suffix of shared libraries on the current platform
+    static std::string get_plugin_extension();
+    Result check(const comproenv_buffer &input, const comproenv_buffer &output, const comproenv_buffer &answer) const;
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_CHECKER_H
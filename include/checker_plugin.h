@@ -0,0 +1,54 @@
+#ifndef INCLUDE_CHECKER_PLUGIN_H
+#define INCLUDE_CHECKER_PLUGIN_H
+/*
+ * C ABI of checker plugins: shared libraries which are loaded by comproenv
+ * once per testing and called in-process for every test.
+ *
+ * Plugin exports two functions:
+ *     int comproenv_checker_version(void);
+ *         returns COMPROENV_CHECKER_VERSION the plugin was built with
+ *     int comproenv_check(const comproenv_buffer *input, const comproenv_buffer *output,
+ *                         const comproenv_buffer *answer, const char *arguments,
+ *                         char *message, size_t message_size);
+ *         returns one of comproenv_verdict values (same as testlib exit codes),
+ *         message may be filled with a zero-terminated explanation.
+ *
+ * comproenv_check is called from several threads at once, so it must not use
+ * global state without synchronization. Buffers are valid only during the call.
+ */
+#include <stddef.h>
+
+#ifdef _WIN32
+#define COMPROENV_EXPORT __declspec(dllexport)
+#else
+#define COMPROENV_EXPORT __attribute__((visibility("default")))
+#endif  /* _WIN32 */
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#define COMPROENV_CHECKER_VERSION 1
+
+typedef struct comproenv_buffer {
+    const char *data;
+    size_t size;
+} comproenv_buffer;
+
+enum comproenv_verdict {
+    COMPROENV_OK = 0,
+    COMPROENV_WRONG_ANSWER = 1,
+    COMPROENV_PRESENTATION_ERROR = 2,
+    COMPROENV_FAIL = 3
+};
+
+typedef int (*comproenv_checker_version_function)(void);
+typedef int (*comproenv_check_function)(const comproenv_buffer *input, const comproenv_buffer *output,
+                                        const comproenv_buffer *answer, const char *arguments,
+                                        char *message, size_t message_size);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+
+#endif  /* INCLUDE_CHECKER_PLUGIN_H */
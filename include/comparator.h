@@ -0,0 +1,122 @@
+#ifndef INCLUDE_COMPARATOR_H
+#define INCLUDE_COMPARATOR_H
+#include <atomic>
+#include <string>
+#include <vector>
+#include "process.h"
+
+namespace comproenv {
+
+// Buffered reader over file descriptor (or memory) which keeps track of position in file
+class StreamReader {
+ private:
+    int fd;
+    bool owns_fd;
+    std::vector <char> buffer;
+    // Either buffer or memory given to the reader
+    const char *base;
+    size_t pos, end;
+    bool eof;
+    int tee_fd;
+    double deadline;
+    const std::atomic <bool> *cancel;
+    size_t max_bytes, bytes_read;
+ public:
+    size_t line, column, offset;
+    // Reading was stopped because of deadline, max_bytes or cancellation
+    bool timed_out, limit_exceeded, cancelled;
+    StreamReader(int file_descriptor, size_t buffer_size = 1 << 16);
+    StreamReader(const std::string &path, size_t buffer_size = 1 << 16);
+    // Memory is not copied and must outlive the reader
+    StreamReader(const char *data, size_t size);
+    StreamReader(const StreamReader &) = delete;
+    StreamReader &operator=(const StreamReader &) = delete;
+    ~StreamReader();
+    bool is_open() const;
+    // Copies everything that is read to another file descriptor
+    void set_tee(int file_descriptor);
+    // Stream is treated as ended at the given moment of Process::current_time()
+    // (is not supported on Windows)
+    void set_deadline(double moment);
+    // Stream is treated as ended as soon as the flag is set (is not supported on Windows)
+    void set_cancel(const std::atomic <bool> *flag);
+    // Stream is treated as ended after the given number of bytes
+    void set_max_bytes(size_t bytes);
+    bool refill();
+    // Returns next byte or -1 at the end of stream
+    int peek() {
+        if (pos == end && !refill())
+            return -1;
+        return (unsigned char)base[pos];
+    }
+    // Buffered bytes which are not consumed yet
+    const char *data() const {
+        return base + pos;
+    }
+    size_t available() const {
+        return end - pos;
+    }
+    // Consumes bytes that contain given number of newlines,
+    // last_newline is index of the last one (if there are any)
+    void skip(size_t bytes, size_t newlines, size_t last_newline) {
+        if (newlines) {
+            line += newlines;
+            column = bytes - last_newline;
+        } else {
+            column += bytes;
+        }
+        pos += bytes;
+        offset += bytes;
+    }
+    void advance() {
+        if (base[pos++] == '\n') {
+            ++line;
+            column = 1;
+        } else {
+            ++column;
+        }
+        ++offset;
+    }
+};
+
+struct CompareOptions {
+    // Numeric tokens are equal if their absolute or relative error does not
+    // exceed epsilon, negative value means exact comparison of all tokens
+    double epsilon = -1;
+};
+
+class TokenComparator {
+ public:
+    struct Position {
+        size_t line = 1, column = 1, offset = 0;
+    };
+    struct Result {
+        bool equal = true;
+        // Position and (possibly truncated) text of the first mismatching tokens,
+        // empty token means that stream has ended
+        Position result_position, expected_position;
+        std::string result_token, expected_token;
+    };
+    // Maximum length of mismatching token kept for the report
+    static constexpr size_t max_token_length = 64;
+    // Longer tokens are never parsed as numbers
+    static constexpr size_t max_number_length = 512;
+    // Compares two streams token by token (tokens are separated by whitespaces),
+    // memory usage does not depend on size of streams
+    static Result compare(StreamReader &result, StreamReader &expected,
+                          const CompareOptions &options = CompareOptions());
+    static Result compare(const std::string &result_path, const std::string &expected_path,
+                          const CompareOptions &options = CompareOptions());
+    // Description of the first mismatch: tokens and their positions
+    static std::string describe(const Result &result);
+    // Compares output of started process (with ProcessOptions::stdout_pipe) while it
+    // is produced and kills the process on the first mismatching token, extra output, exceeded
+    // output limit or wall time. Output that was read is copied to capture.
+    static Result compare_running(Process &process, const OutputCapture &capture,
+                                  const std::string &expected_path, size_t output_limit,
+                                  const CompareOptions &options = CompareOptions());
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_COMPARATOR_H
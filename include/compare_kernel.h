@@ -0,0 +1,34 @@
+#ifndef INCLUDE_COMPARE_KERNEL_H
+#define INCLUDE_COMPARE_KERNEL_H
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace comproenv {
+
+// Vectorized search of the first differing byte, implementation is selected at runtime
+class CompareKernel {
+ public:
+    struct Prefix {
+        size_t length = 0;
+        size_t newlines = 0;
+        // Index of the last '\n' within the common prefix (npos if there is no such)
+        size_t last_newline = npos;
+    };
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    using Function = Prefix (*)(const char *a, const char *b, size_t size);
+    // Returns length of the common prefix of a and b and newlines found in it
+    static Prefix common_prefix(const char *a, const char *b, size_t size) {
+        return implementation(a, b, size);
+    }
+    static std::string get_name();
+    // Names of implementations supported by current CPU, the best one goes first
+    static std::vector <std::string> get_available();
+    static bool select(const std::string &name);
+ private:
+    static Function implementation;
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_COMPARE_KERNEL_H
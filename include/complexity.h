@@ -0,0 +1,28 @@
+#ifndef INCLUDE_COMPLEXITY_H
+#define INCLUDE_COMPLEXITY_H
+#include <string>
+#include <vector>
+
+namespace comproenv {
+
+// Running time modeled as overhead + coefficient * f(n), overhead includes start of the process
+struct ComplexityFit {
+    std::string name;
+    double (*function)(double) = nullptr;
+    double overhead = 0;
+    double coefficient = 0;
+    // Root mean square of relative errors of the model on measurements
+    double error = 0;
+    double predict(double size) const;
+};
+
+class Complexity {
+ public:
+    // Fits times measured on sizes to standard complexity classes (from O(1) to O(n^3)),
+    // the best fit goes first
+    static std::vector <ComplexityFit> fit(const std::vector <double> &sizes, const std::vector <double> &times);
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_COMPLEXITY_H
@@ -9,6 +9,8 @@ const static std::string data_folder = "data";
 const static std::string env_prefix = (fs::path(data_folder) / "env_").string();
 const static std::string task_prefix = "task_";
 const static std::string cache_file_name = ".comproenv_cache";
+const static std::string test_cache_file_name = ".test_cache";
+const static std::string run_history_file_name = ".run_history";
 const static std::string application_name = "comproenv";
 
 }  // namespace comproenv
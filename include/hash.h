@@ -0,0 +1,27 @@
+#ifndef INCLUDE_HASH_H
+#define INCLUDE_HASH_H
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace comproenv {
+
+// Incremental 64-bit FNV-1a hash, stable between runs and platforms
+class Hasher {
+ private:
+    uint64_t state;
+ public:
+    Hasher();
+    Hasher &update(const void *data, size_t size);
+    Hasher &update(std::string_view data);
+    Hasher &update(uint64_t value);
+    // Hashes size and content of file, returns false if the file can not be read
+    bool update_file(const std::string &path);
+    uint64_t digest() const;
+    // Digest as 16 hexadecimal digits
+    std::string hex_digest() const;
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_HASH_H
@@ -0,0 +1,37 @@
+#ifndef INCLUDE_INTERACTION_H
+#define INCLUDE_INTERACTION_H
+#include <string>
+#include "process.h"
+
+namespace comproenv {
+
+struct InteractionResult {
+    ProcessResult solution, interactor;
+    // Statistics below are collected only if the traffic was relayed by comproenv, the relay
+    // adds a copy and a context switch to every exchange, so it is included in the latency
+    bool relayed = false;
+    // Exchange is a message from interactor followed by the reply of solution,
+    // latency is the time between delivery of the message and the first byte of reply
+    size_t exchanges = 0;
+    double total_latency = 0;
+    double max_latency = 0;
+    size_t solution_bytes = 0;
+    size_t interactor_bytes = 0;
+    std::string error;
+};
+
+class Interaction {
+ public:
+    // Launches solution and interactor, stdout of each one is connected to stdin of the other one
+    // by a pipe. With relay the traffic goes through comproenv instead, so that exchanges are
+    // counted and solution output is copied to transcript (if it is not nullptr).
+    // Only commands, limits, stderr capture and cancel flag (of the solution) are taken from options.
+    static InteractionResult run(const ProcessOptions &solution_options, const ProcessOptions &interactor_options,
+                                 bool relay, const OutputCapture *transcript = nullptr);
+    // Human-readable statistics of exchanges
+    static std::string format_stats(const InteractionResult &result);
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_INTERACTION_H
@@ -0,0 +1,36 @@
+#ifndef INCLUDE_MINIMIZER_H
+#define INCLUDE_MINIMIZER_H
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace comproenv {
+
+// Delta debugging of failing tests: lines and tokens are removed and numbers are
+// shrunk while the test still fails
+class Minimizer {
+ public:
+    // Returns true if the solution still fails on the test, it is called from several threads at once
+    using Predicate = std::function<bool(const std::string &)>;
+    // Called after every successful reduction with the current size of the test
+    using Progress = std::function<void(size_t)>;
+ private:
+    Predicate still_fails;
+    unsigned jobs;
+    size_t evaluations;
+    // Index of the first candidate that still fails, candidates are evaluated in parallel
+    std::optional <size_t> find_failing(const std::vector <std::string> &candidates);
+    // Removes chunks of units (ddmin), returns true if the test was reduced
+    bool remove_units(std::vector <std::string> &units, const Progress &progress);
+    bool shrink_numbers(std::vector <std::string> &units, const Progress &progress);
+ public:
+    Minimizer(const Predicate &predicate, unsigned jobs_count = 0);
+    std::string minimize(const std::string &test, const Progress &progress);
+    // Number of evaluations of the predicate during the last minimization
+    size_t get_evaluations() const;
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_MINIMIZER_H
@@ -0,0 +1,44 @@
+#ifndef INCLUDE_PERF_COUNTERS_H
+#define INCLUDE_PERF_COUNTERS_H
+#include <array>
+#include <string>
+
+namespace comproenv {
+
+// Numbers of events that happened in a process, -1 means that the event was not counted
+struct PerfCounts {
+    enum Event {
+        // Hardware events
+        INSTRUCTIONS, CYCLES, BRANCH_MISSES, CACHE_MISSES,
+        // Software events, available when hardware counters are not (e.g. in virtual machines)
+        PAGE_FAULTS, TASK_CLOCK,
+        EVENTS_COUNT
+    };
+    std::array <long long, EVENTS_COUNT> values;
+    PerfCounts();
+    bool available() const;
+    // Sum of counts, events that were not counted in one of them are skipped
+    PerfCounts &operator+=(const PerfCounts &other);
+    // Human-readable list of counted events
+    std::string format() const;
+};
+
+// Counters opened with perf_event_open (Linux only) for a process and its children
+class PerfCounters {
+ private:
+    std::array <int, PerfCounts::EVENTS_COUNT> fds;
+ public:
+    PerfCounters();
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+    ~PerfCounters();
+    // Counting starts when the process calls exec, so it must not do it before this call
+    // returns. Returns false if none of the counters can be opened.
+    bool open(int pid, std::string &error);
+    PerfCounts read() const;
+    void close();
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_PERF_COUNTERS_H
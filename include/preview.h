@@ -0,0 +1,41 @@
+#ifndef INCLUDE_PREVIEW_H
+#define INCLUDE_PREVIEW_H
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace comproenv {
+
+struct PreviewOptions {
+    // Limits of the beginning that is shown, negative values mean no limit
+    int max_lines = 100;
+    int max_chars = -1;
+    // Lines from the end that are shown after the skipped part
+    int tail_lines = 0;
+    // Bytes of the head and of the tail, so that a test of one long line is not shown entirely,
+    // negative value means no limit
+    int max_bytes = 4096;
+};
+
+// Place in a file which is shown with surrounding lines
+struct FileSpot {
+    std::string path;
+    size_t offset = 0;
+    size_t line = 1;
+    size_t column = 1;
+};
+
+// Bounded view of test files: only the head (and tail) is read, lines of the skipped part are
+// counted within a fixed budget, so cost of preview does not depend on size of the file
+class Preview {
+ public:
+    static void print_file(std::ostream &out, const std::string &path, const PreviewOptions &options);
+    static void print_text(std::ostream &out, std::string_view text, const PreviewOptions &options);
+    // Lines around the spots of the first mismatch in result and expected files, lines of
+    // the same distance from the spots that differ are marked, files are not read entirely
+    static void print_diff(std::ostream &out, const FileSpot &result, const FileSpot &expected, int context_lines);
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_PREVIEW_H
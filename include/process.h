@@ -0,0 +1,157 @@
+#ifndef INCLUDE_PROCESS_H
+#define INCLUDE_PROCESS_H
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include "perf_counters.h"
+
+namespace comproenv {
+
+// Storage for output of child process: memfd (if available) or temporary file
+class OutputCapture {
+ private:
+    int fd;
+    std::string path;
+    bool temporary_file;
+ public:
+    OutputCapture();
+    OutputCapture(const OutputCapture &) = delete;
+    OutputCapture &operator=(const OutputCapture &) = delete;
+    ~OutputCapture();
+    int get_fd() const;
+    // Path which can be used to read captured output from the current process
+    const std::string &get_path() const;
+};
+
+// Zero value of any limit means that it is not set
+struct ProcessLimits {
+    // CPU time in seconds, process is also killed after 2 * time_limit + 1 seconds of wall time
+    double time_limit = 0;
+    // Bytes of address space
+    size_t memory_limit = 0;
+    // Bytes written to captured stdout
+    size_t output_limit = 0;
+};
+
+struct ProcessOptions {
+    std::string command;
+    ProcessLimits limits;
+    // Empty path means that stdin is inherited from comproenv,
+    // the file is given to the process as a directly opened descriptor
+    std::string stdin_path;
+    // Feed stdin_path through a pipe, for programs that need one
+    bool stdin_pipe = false;
+    // Data fed to stdin through a pipe when stdin_path is empty (e.g. generated input),
+    // it must stay unchanged until the process is waited. Pages of comproenv are counted
+    // in peak memory of a forked child on Linux, so big inputs should be given as files.
+    const std::string *stdin_data = nullptr;
+    // nullptr means that stdout is inherited from comproenv
+    const OutputCapture *stdout_capture = nullptr;
+    // nullptr means that stderr is inherited from comproenv
+    const OutputCapture *stderr_capture = nullptr;
+    // Connect stdin to a pipe that can be written using Process::get_stdin_pipe()
+    // (is not supported on Windows)
+    bool stdin_writer = false;
+    // Connect stdout to a pipe that can be read using Process::get_stdout_pipe()
+    // (is not supported on Windows)
+    bool stdout_pipe = false;
+    // Descriptors given to the process as stdin and stdout when the options above do not set them
+    // (e.g. ends of pipes to another process), they are not closed by Process (is not supported on Windows)
+    int stdin_fd = -1;
+    int stdout_fd = -1;
+    // Count hardware and software events using perf_event_open (Linux only)
+    bool perf_counters = false;
+    // Process is killed soon after the flag is set, e.g. when other tests have already failed
+    // (is not supported on Windows)
+    const std::atomic <bool> *cancel = nullptr;
+};
+
+struct ProcessResult {
+    enum class Limit {
+        NONE, TIME, MEMORY, OUTPUT
+    };
+    bool launched = false;
+    // Exit status of process or 128 + number of signal that terminated it
+    int exit_code = 0;
+    int term_signal = 0;
+    double wall_time = 0;
+    // CPU time is a sum of user and system time
+    double cpu_time = 0;
+    double user_time = 0;
+    double system_time = 0;
+    // Peak resident set size in bytes
+    size_t peak_memory = 0;
+    long voluntary_context_switches = 0;
+    long involuntary_context_switches = 0;
+    // Bytes fed to stdin through a pipe and time spent on it
+    size_t input_bytes = 0;
+    double input_time = 0;
+    // Counted only if ProcessOptions::perf_counters is set
+    PerfCounts perf_counts;
+    Limit exceeded_limit = Limit::NONE;
+    // Process failed when it used at least half of memory limit, so it may be a failed allocation
+    bool possibly_out_of_memory = false;
+    // Process was killed by comproenv, so its exit code should not be treated as error
+    bool killed = false;
+    std::string error;
+};
+
+class Process {
+ private:
+    ProcessOptions options;
+    #ifndef _WIN32
+    int pid;
+    int stdin_pipe, stdout_pipe;
+    std::thread input_feeder;
+    std::atomic <bool> stop_feeding;
+    size_t fed_bytes;
+    double feeding_time;
+    void feed_input(int pipe_fd, int file_fd);
+    PerfCounters perf_counters;
+    #endif  // _WIN32
+    double start_time;
+    bool kill_requested;
+    ProcessResult::Limit kill_reason;
+    ProcessResult result;
+    void check_limits();
+ public:
+    Process(const ProcessOptions &process_options);
+    Process(const Process &) = delete;
+    Process &operator=(const Process &) = delete;
+    ~Process();
+    bool start();
+    ProcessResult wait();
+    // Kills process, reason is reported as exceeded limit
+    void kill(ProcessResult::Limit reason = ProcessResult::Limit::NONE);
+    int get_stdin_pipe() const;
+    // Closes stdin pipe, so that process reads end of file
+    void close_stdin_pipe();
+    int get_stdout_pipe() const;
+    // Moment (in seconds of steady clock) when process is killed because of time limit,
+    // 0 if there is no time limit
+    double get_deadline() const;
+    // Flag from ProcessOptions::cancel, loops that wait for the process check it too
+    const std::atomic <bool> *get_cancel() const;
+    static double current_time();
+    // Pipe with close-on-exec descriptors which are not leaked to processes started by other threads
+    // (is not supported on Windows)
+    static bool create_pipe(int fds[2]);
+    // Kills running processes and makes new ones fail to start until clear_interrupt is called,
+    // it is async-signal-safe, so that it is called on Ctrl-C (is not supported on Windows)
+    static void interrupt();
+    static void clear_interrupt();
+    static bool is_interrupted();
+    // Splits command line into arguments. Returns false if the command
+    // uses shell features (pipes, redirections, variables) and must be
+    // launched through the shell
+    static bool split_command(std::vector <std::string> &out, const std::string_view command);
+    static ProcessResult run(const ProcessOptions &process_options);
+    // Human-readable description of resources used by finished process
+    static std::string format_usage(const ProcessResult &result);
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_PROCESS_H
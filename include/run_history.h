@@ -0,0 +1,63 @@
+#ifndef INCLUDE_RUN_HISTORY_H
+#define INCLUDE_RUN_HISTORY_H
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace comproenv {
+
+// Result of one launch of the solution on a test
+struct RunRecord {
+    // Seconds since epoch when testing was started
+    int64_t timestamp = 0;
+    // Hash of the solution (compiled binary or source for interpreted languages)
+    std::string version;
+    std::string test;
+    std::string verdict;
+    double cpu_time = 0;
+    double wall_time = 0;
+    size_t peak_memory = 0;
+};
+
+// Times of a test with one version of the solution, only passed runs are counted
+struct VersionTiming {
+    std::string version;
+    size_t runs = 0;
+    double median_cpu_time = 0;
+    double median_wall_time = 0;
+    size_t peak_memory = 0;
+};
+
+struct TestTrend {
+    std::string test;
+    // Versions in order of their latest run
+    std::vector <VersionTiming> versions;
+    // Relative change of median CPU time of the last version compared to the previous one,
+    // 0 if there is no previous version
+    double change() const;
+};
+
+// Append-only log of test runs stored in a text file inside of task directory,
+// each line is "<timestamp> <version> <verdict> <cpu time> <wall time> <peak memory> <test name>".
+// The last run of every test is also kept in "<file>.last" in the same format, so that
+// scheduling does not have to parse the whole log which only grows
+class RunHistory {
+ private:
+    std::string path;
+    std::string last_runs_path;
+ public:
+    RunHistory(const std::string &file_path);
+    // Records of one testing are appended with a single write, the last runs are rewritten
+    bool append(const std::vector <RunRecord> &records) const;
+    // Malformed lines (e.g. written partially) are skipped
+    bool load(std::vector <RunRecord> &records) const;
+    // Reads the last runs, they are taken from the whole log if they were not stored yet
+    std::map <std::string, RunRecord> load_last_runs() const;
+    // Trends of tests sorted by name
+    static std::vector <TestTrend> get_trends(const std::vector <RunRecord> &records);
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_RUN_HISTORY_H
@@ -6,9 +6,15 @@
 #include <map>
 #include <optional>
 #include <functional>
+#include <memory>
+#include "fs.h"
 #include "utils.h"
 #include "environment.h"
 #include "task.h"
+#include "checker.h"
+#include "preview.h"
+#include "process.h"
+#include "stress.h"
 #include "yaml_parser.h"
 
 namespace comproenv {
@@ -65,6 +71,28 @@ class Shell {
                     std::function<int(std::vector <std::string> &)> func);
     void add_alias(int old_state, std::string new_name, int new_state, std::string old_name);
     std::optional <std::string> get_setting_by_name(const std::string name);
+    double get_number_setting(const std::string name, double default_value);
+    ProcessLimits get_process_limits();
+    // Limits of test previews: max_lines_count, max_chars_count, preview_tail_lines
+    // and preview_max_bytes
+    PreviewOptions get_preview_options();
+    // Command that launches helper program (checker, interactor) built from the source file in
+    // current task directory: runner_<language> for interpreted languages or compiled binary.
+    // program is set to the file that has to exist to launch the command.
+    std::string get_helper_command(const std::string &source, std::string &program);
+    // Command that launches the solution of current task
+    std::string get_runner_command();
+    // Input files of tests with given names (all tests of current task if names are empty),
+    // missing tests are reported and skipped
+    std::vector <fs::path> get_tests(const std::vector <std::string> &names);
+    // Checker of current task: in-process checker (built-in or plugin) or nullptr and command of
+    // external checker, program is set to the loaded plugin or external checker
+    std::unique_ptr <Checker> get_checker(std::string &command, std::string &program);
+    // Command that launches generator of current task, throws if there is no generator
+    std::string get_generator_command();
+    // Solution, reference solution (if it is set), limits and checker of current task,
+    // checker owns in-process checker used by the options
+    StressOptions get_stress_options(std::unique_ptr <Checker> &checker);
  public:
     Shell(const std::string_view config_file_path = "", const std::string_view environments_file_path = "");
     void run();
@@ -0,0 +1,59 @@
+#ifndef INCLUDE_SLOW_HUNTER_H
+#define INCLUDE_SLOW_HUNTER_H
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "stress.h"
+
+namespace comproenv {
+
+struct HuntOptions {
+    // Ranges of integer parameters which are given to the generator before the seed
+    std::vector <std::pair <int64_t, int64_t>> parameters;
+    // Number of the slowest inputs that are kept
+    size_t keep = 5;
+    // Fitness is the number of instructions if it is counted, CPU time otherwise
+    bool instructions = false;
+};
+
+struct HuntCandidate {
+    std::vector <int64_t> parameters;
+    uint64_t seed = 0;
+    double fitness = 0;
+    // Result of the solution, input is not filled
+    StressCase test;
+    // Command line arguments of the generator
+    std::string get_arguments() const;
+};
+
+// Evolutionary search of generator arguments on which the solution is the slowest:
+// new candidates are mutations of the best ones (or random ones), they are evaluated
+// in parallel batches. Only inputs on which the solution passes or exceeds the time
+// limit are kept, other failures are counted.
+class SlowHunter {
+ private:
+    StressTester tester;
+    HuntOptions options;
+ public:
+    struct Result {
+        size_t evaluations = 0;
+        // Failures of the solution other than time limit exceeded
+        size_t failures = 0;
+        // Fitness was measured as the number of instructions
+        bool instructions = false;
+        // The slowest candidates, the slowest goes first
+        std::vector <HuntCandidate> slowest;
+        // Generator failed
+        std::string error;
+    };
+    SlowHunter(const StressOptions &stress_options, const HuntOptions &hunt_options);
+    // progress(evaluations, CPU time on the slowest input) is called after every batch
+    Result run(uint64_t seed, size_t evaluations, unsigned jobs,
+               const std::function<void(size_t, double)> &progress) const;
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_SLOW_HUNTER_H
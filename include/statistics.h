@@ -0,0 +1,26 @@
+#ifndef INCLUDE_STATISTICS_H
+#define INCLUDE_STATISTICS_H
+#include <vector>
+
+namespace comproenv {
+
+// Summary of repeated measurements of the same value
+struct SampleStatistics {
+    size_t count = 0;
+    double min = 0;
+    double max = 0;
+    double median = 0;
+    double mean = 0;
+    double p95 = 0;
+    // Sample standard deviation (with Bessel's correction)
+    double stddev = 0;
+    // Coefficient of variation: standard deviation relative to mean
+    double variation() const;
+    static SampleStatistics compute(std::vector <double> values);
+    // Quantile q from [0, 1] of sorted values, interpolated linearly between closest ranks
+    static double quantile(const std::vector <double> &sorted_values, double q);
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_STATISTICS_H
@@ -0,0 +1,74 @@
+#ifndef INCLUDE_STRESS_H
+#define INCLUDE_STRESS_H
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include "checker.h"
+#include "process.h"
+#include "test_runner.h"
+
+namespace comproenv {
+
+struct StressOptions {
+    // Seed of the test is appended as the last argument, test is read from stdout
+    std::string generator_command;
+    // Reference solution is trusted, so it is launched without limits. Without reference solution
+    // only failures of the solution itself (runtime errors and exceeded limits) are detected
+    std::string reference_command;
+    std::string solution_command;
+    ProcessLimits limits;
+    // In-process checker (built-in or plugin), external checker command is used if it is nullptr
+    const Checker *checker = nullptr;
+    std::string checker_command;
+    // Count events of the solution using perf_event_open (Linux only)
+    bool perf_counters = false;
+    // Stderr of solution and reference solution is captured instead of being inherited,
+    // e.g. so that many crashing candidates of minimize do not flood the terminal
+    bool capture_stderr = false;
+};
+
+struct StressCase {
+    // Test is not valid if reference solution failed on it
+    bool valid = true;
+    TestRunner::Verdict verdict = TestRunner::Verdict::OK;
+    // Reason of failure of solution or reference solution
+    std::string message;
+    ProcessResult solution;
+    // Filled only if the solution failed, errors are stderr of the solution (see capture_stderr)
+    std::string input, answer, output, errors;
+};
+
+// Compares solution with reference solution on generated or given tests
+class StressTester {
+ private:
+    StressOptions options;
+ public:
+    struct Result {
+        // Number of finished iterations
+        size_t iterations = 0;
+        // First (by seed) failed test
+        std::optional <StressCase> failure;
+        uint64_t seed = 0;
+        // Generator or reference solution failed
+        std::string error;
+    };
+    StressTester(const StressOptions &stress_options);
+    // Writes test generated with seed into input, returns false if generator failed
+    bool generate(uint64_t seed, const OutputCapture &input, std::string &error) const;
+    // Generator gets the arguments instead of the seed
+    bool generate(const std::string &arguments, const OutputCapture &input, std::string &error) const;
+    // Launches reference solution and solution on the test and checks the output of solution
+    StressCase check(const OutputCapture &input) const;
+    StressCase check(const std::string &input) const;
+    // Checks tests with seeds [first_seed, first_seed + iterations) on jobs threads until the first
+    // failure, progress(finished iterations) is called from the calling thread a few times a second
+    Result run(uint64_t first_seed, size_t iterations, unsigned jobs,
+               const std::function<void(size_t)> &progress) const;
+    // Whole content of captured output
+    static std::string read_capture(const OutputCapture &capture);
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_STRESS_H
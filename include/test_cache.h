@@ -0,0 +1,27 @@
+#ifndef INCLUDE_TEST_CACHE_H
+#define INCLUDE_TEST_CACHE_H
+#include <string>
+#include <map>
+
+namespace comproenv {
+
+// Keys of passed tests stored in a text file inside of task directory,
+// each line is "<key> <test name>"
+class TestCache {
+ private:
+    std::string path;
+    std::map <std::string, std::string> entries;
+    bool modified;
+ public:
+    TestCache(const std::string &file_path);
+    bool load();
+    bool save();
+    // Returns true if the test has passed with the same key
+    bool contains(const std::string &test_name, const std::string &key) const;
+    void store(const std::string &test_name, const std::string &key);
+    void erase(const std::string &test_name);
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_TEST_CACHE_H
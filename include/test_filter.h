@@ -0,0 +1,34 @@
+#ifndef INCLUDE_TEST_FILTER_H
+#define INCLUDE_TEST_FILTER_H
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace comproenv {
+
+// Selection of tests by name (path relative to tests directory without extension)
+class TestFilter {
+ private:
+    // Test matches if it matches any of glob patterns
+    std::vector <std::string> globs;
+    std::optional <std::regex> regex;
+    // Shard index from [0, shards_count)
+    size_t shard = 0;
+    size_t shards_count = 1;
+ public:
+    // Patterns with * (any characters), ? (any character) and [...] (character set)
+    void add_glob(const std::string &pattern);
+    // Tests whose names contain a match of ECMAScript regular expression, throws std::regex_error
+    void set_regex(const std::string &pattern);
+    // Shard "i/n" (1 <= i <= n) contains tests with hash of name equal to i - 1 modulo n, so
+    // n invocations with different shards run every test exactly once. Throws std::invalid_argument
+    void set_shard(const std::string &shard_description);
+    bool empty() const;
+    bool matches(const std::string &test_name) const;
+    static bool match_glob(const std::string &pattern, const std::string &name);
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_TEST_FILTER_H
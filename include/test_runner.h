@@ -0,0 +1,58 @@
+#ifndef INCLUDE_TEST_RUNNER_H
+#define INCLUDE_TEST_RUNNER_H
+#include <string>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "process.h"
+
+namespace comproenv {
+
+class TestRunner {
+ public:
+    enum class Verdict {
+        OK, RUNTIME_ERROR, MISMATCH,
+        TIME_LIMIT_EXCEEDED, MEMORY_LIMIT_EXCEEDED, OUTPUT_LIMIT_EXCEEDED,
+        // Reported by external checker
+        PRESENTATION_ERROR, CHECKER_FAILED
+    };
+    struct Result {
+        Verdict verdict = Verdict::OK;
+        // Everything the test wants to print, flushed in test order
+        std::string report;
+        // Resources used by the solution
+        ProcessResult process;
+        // Result was taken from the test cache, the solution was not launched
+        bool cached = false;
+    };
+ private:
+    unsigned jobs;
+    std::vector <size_t> order;
+ public:
+    TestRunner(unsigned jobs_count = 0);
+    static unsigned default_jobs();
+    // Short name of verdict (like OK, WA, TLE)
+    static std::string get_verdict_name(Verdict verdict);
+    unsigned get_jobs() const;
+    // Order in which tests are started (permutation of their indices), by default tests are
+    // started in index order. Results are reported in index order anyway.
+    void set_order(const std::vector <size_t> &test_order);
+    // Runs tests [0, tests_count) on a pool of worker threads.
+    // on_result is called from the calling thread strictly in test order.
+    void run(size_t tests_count,
+             const std::function<Result(size_t)> &run_test,
+             const std::function<void(size_t, Result &)> &on_result) const;
+    // Same as run, but testing stops at the first (in test order) test for which is_last returns true.
+    // is_last is called from worker threads as soon as a test finishes: tests after it are not
+    // started and running ones are cancelled through the flag given to run_test (see
+    // ProcessOptions::cancel). Tests before it are still finished and reported, so testing stops
+    // at the same test regardless of scheduling. Returns number of reported tests.
+    size_t run_until(size_t tests_count,
+                     const std::function<Result(size_t, const std::atomic <bool> &)> &run_test,
+                     const std::function<bool(const Result &)> &is_last,
+                     const std::function<void(size_t, Result &)> &on_result) const;
+};
+
+}  // namespace comproenv
+
+#endif  // INCLUDE_TEST_RUNNER_H
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "fs.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif  // _WIN32
+#include "checker.h"
+#include "comparator.h"
+#include "hash.h"
+
+namespace comproenv {
+
+MappedFile::MappedFile(const std::string &path) : data(nullptr), size(0), mapped(false) {
+    #ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void *mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<const char *>(mapping);
+            size = (size_t)info.st_size;
+            mapped = true;
+        }
+    }
+    close(fd);
+    if (mapped)
+        return;
+    #endif  // _WIN32
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open())
+        return;
+    std::ostringstream buffer;
+    buffer << f.rdbuf();
+    content = buffer.str();
+    data = content.data();
+    size = content.size();
+}
+
+MappedFile::~MappedFile() {
+    #ifndef _WIN32
+    if (mapped)
+        munmap(const_cast<char *>(data), size);
+    #endif  // _WIN32
+}
+
+comproenv_buffer MappedFile::get_buffer() const {
+    return {data, size};
+}
+
+static void set_message(char *message, size_t message_size, const std::string &text) {
+    if (message_size == 0)
+        return;
+    size_t length = std::min(text.size(), message_size - 1);
+    std::memcpy(message, text.data(), length);
+    message[length] = '\0';
+}
+
+// Arguments are empty for exact comparison or epsilon for numbers
+static int check_tokens(const comproenv_buffer *, const comproenv_buffer *output,
+                        const comproenv_buffer *answer, const char *arguments,
+                        char *message, size_t message_size) {
+    CompareOptions options;
+    if (arguments && *arguments) {
+        char *end;
+        options.epsilon = std::strtod(arguments, &end);
+        if (*end != '\0' || !(options.epsilon >= 0)) {
+            set_message(message, message_size, std::string("Incorrect precision ") + arguments);
+            return COMPROENV_FAIL;
+        }
+    }
+    StreamReader result(output->data, output->size), expected(answer->data, answer->size);
+    TokenComparator::Result comparison = TokenComparator::compare(result, expected, options);
+    if (comparison.equal)
+        return COMPROENV_OK;
+    set_message(message, message_size, "First mismatch: " + TokenComparator::describe(comparison));
+    return COMPROENV_WRONG_ANSWER;
+}
+
+// Hash of tokens, so that it does not depend on whitespaces
+static std::string hash_tokens(const comproenv_buffer *buffer) {
+    Hasher hasher;
+    size_t pos = 0;
+    while (pos < buffer->size) {
+        while (pos < buffer->size && std::isspace((unsigned char)buffer->data[pos]))
+            ++pos;
+        size_t start = pos;
+        while (pos < buffer->size && !std::isspace((unsigned char)buffer->data[pos]))
+            ++pos;
+        if (pos > start)
+            hasher.update(std::string_view(buffer->data + start, pos - start));
+    }
+    return hasher.hex_digest();
+}
+
+// Answer is either expected output or hash of its tokens (that is printed on mismatch),
+// so that huge answers do not have to be stored
+static int check_hash(const comproenv_buffer *, const comproenv_buffer *output,
+                      const comproenv_buffer *answer, const char *,
+                      char *message, size_t message_size) {
+    std::string result_hash = hash_tokens(output);
+    std::string answer_text(answer->data, answer->size);
+    while (!answer_text.empty() && std::isspace((unsigned char)answer_text.back()))
+        answer_text.pop_back();
+    if (result_hash == answer_text || result_hash == hash_tokens(answer))
+        return COMPROENV_OK;
+    set_message(message, message_size, "Hash of result is " + result_hash);
+    return COMPROENV_WRONG_ANSWER;
+}
+
+Checker::Checker(comproenv_check_function check_function, const std::string &check_arguments, void *library_handle) :
+    function(check_function), arguments(check_arguments), library(library_handle) {
+
+}
+
+Checker::~Checker() {
+    if (!library)
+        return;
+    #ifdef _WIN32
+    FreeLibrary(static_cast<HMODULE>(library));
+    #else
+    dlclose(library);
+    #endif  // _WIN32
+}
+
+std::unique_ptr <Checker> Checker::create_builtin(const std::string &name) {
+    if (name == "tokens")
+        return std::unique_ptr <Checker>(new Checker(check_tokens, "", nullptr));
+    if (name.compare(0, std::size("float:") - 1, "float:") == 0)
+        return std::unique_ptr <Checker>(new Checker(check_tokens, name.substr(std::size("float:") - 1), nullptr));
+    if (name == "hash")
+        return std::unique_ptr <Checker>(new Checker(check_hash, "", nullptr));
+    return nullptr;
+}
+
+std::unique_ptr <Checker> Checker::load_plugin(const std::string &path, std::string &error) {
+    // Relative path would be searched in system directories
+    std::string full_path = fs::absolute(path).string();
+    #ifdef _WIN32
+    HMODULE library = LoadLibraryA(full_path.c_str());
+    if (!library) {
+        error = "Unable to load " + path + ": error " + std::to_string(GetLastError());
+        return nullptr;
+    }
+    auto get_symbol = [library](const char *name) {
+        return reinterpret_cast<void *>(GetProcAddress(library, name));
+    };
+    auto unload = [library]() { FreeLibrary(library); };
+    #else
+    void *library = dlopen(full_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!library) {
+        const char *message = dlerror();
+        error = "Unable to load " + path + ": " + (message ? message : "unknown error");
+        return nullptr;
+    }
+    auto get_symbol = [library](const char *name) {
+        return dlsym(library, name);
+    };
+    auto unload = [library]() { dlclose(library); };
+    #endif  // _WIN32
+    auto version = reinterpret_cast<comproenv_checker_version_function>(get_symbol("comproenv_checker_version"));
+    auto function = reinterpret_cast<comproenv_check_function>(get_symbol("comproenv_check"));
+    if (!version || !function) {
+        error = "Plugin " + path + " does not export comproenv_checker_version and comproenv_check";
+        unload();
+        return nullptr;
+    }
+    if (version() != COMPROENV_CHECKER_VERSION) {
+        error = "Plugin " + path + " is built for checker ABI version " + std::to_string(version()) +
+            ", expected " + std::to_string(COMPROENV_CHECKER_VERSION);
+        unload();
+        return nullptr;
+    }
+    return std::unique_ptr <Checker>(new Checker(function, "", library));
+}
+
+std::string Checker::get_plugin_extension() {
+    #if defined(_WIN32)
+    return ".dll";
+    #elif defined(__APPLE__)
+    return ".dylib";
+    #else
+    return ".so";
+    #endif  // _WIN32
+}
+
+Checker::Result Checker::check(const comproenv_buffer &input, const comproenv_buffer &output,
+                               const comproenv_buffer &answer) const {
+    char message[4096] = "";
+    int verdict = function(&input, &output, &answer, arguments.c_str(), message, sizeof(message));
+    message[sizeof(message) - 1] = '\0';
+    Result result;
+    result.message = message;
+    if (verdict < COMPROENV_OK || verdict > COMPROENV_FAIL) {
+        result.verdict = COMPROENV_FAIL;
+        result.message = "Checker returned unknown verdict " + std::to_string(verdict) +
+            (result.message.empty() ? "" : ": " + result.message);
+    } else {
+        result.verdict = static_cast<comproenv_verdict>(verdict);
+    }
+    return result;
+}
+
+}  // namespace comproenv
@@ -10,6 +10,8 @@
 #include <unistd.h>
 #endif  // _WIN32
 #include "const.h"
+#include "preview.h"
+#include "process.h"
 #include "shell.h"
 #include "utils.h"
 
@@ -34,14 +36,14 @@ void Shell::configure_commands_generator() {
         std::cout << "\033[35m" << "-- Compile generator for " <<
             envs[current_env].get_tasks()[current_task].get_name() << ":" <<
             "\033[0m\n";
-        auto time_start = std::chrono::high_resolution_clock::now();
         DEBUG_LOG(command);
-        int ret_code = system(command.c_str());
-        auto time_finish = std::chrono::high_resolution_clock::now();
-        std::cout << "\033[35m" << "-- Time elapsed:" <<
-            std::chrono::duration_cast<std::chrono::duration<double>>(time_finish - time_start).count() <<
-            "\033[0m\n";
-        return ret_code;
+        ProcessOptions options;
+        options.command = command;
+        ProcessResult result = Process::run(options);
+        if (!result.launched)
+            FAILURE(result.error);
+        std::cout << "\033[35m" << "-- Time elapsed:" << Process::format_usage(result) << "\033[0m\n";
+        return result.exit_code;
     });
 
     add_command(State::GENERATOR, "rg", "Run generator",
@@ -80,18 +82,18 @@ void Shell::configure_commands_generator() {
         std::cout << "\033[35m" << "-- Run generator for " <<
             envs[current_env].get_tasks()[current_task].get_name() << ":" <<
             "\033[0m\n";
-        auto time_start = std::chrono::high_resolution_clock::now();
         DEBUG_LOG(command);
-        int ret_code = system(command.c_str());
-        auto time_finish = std::chrono::high_resolution_clock::now();
+        ProcessOptions options;
+        options.command = command;
+        ProcessResult result = Process::run(options);
         if (chdir("../../../..")) {
             std::cout << "Failed to change directory\n";
         }
         DEBUG_LOG("go to: " << fs::current_path().string());
-        std::cout << "\033[35m\n" << "-- Time elapsed:" <<
-            std::chrono::duration_cast<std::chrono::duration<double>>(time_finish - time_start).count() <<
-            "\033[0m\n";
-        return ret_code;
+        if (!result.launched)
+            FAILURE(result.error);
+        std::cout << "\033[35m\n" << "-- Time elapsed:" << Process::format_usage(result) << "\033[0m\n";
+        return result.exit_code;
     });
 
     add_command(State::GENERATOR, "eg", "Edit generator",
@@ -170,26 +172,20 @@ void Shell::configure_commands_generator() {
         std::sort(in_files.begin(), in_files.end());
         std::cout << "\033[32m" << "List of tests for task " <<
             envs[current_env].get_tasks()[current_task].get_name() << "\033[0m" << '\n';
+        PreviewOptions preview_options = get_preview_options();
         for (auto &in_file : in_files) {
             std::cout << "\033[33m" << "Test " << in_file << "\033[0m" << '\n';
             std::cout << "\033[35m" << "-- Input:" << "\033[0m" << '\n';
-            std::string buf;
-            std::ifstream f(in_file);
-            if (!f.is_open())
+            if (!std::ifstream(in_file).is_open())
                 return -1;
-            while (std::getline(f, buf))
-                std::cout << buf << '\n';
-            f.close();
+            Preview::print_file(std::cout, in_file.string(), preview_options);
             std::string out_file = in_file.string();
             out_file.pop_back();
             out_file.pop_back();
             out_file += "out";
-            f.open(out_file);
-            if (f.is_open()) {
+            if (fs::is_regular_file(out_file)) {
                 std::cout << "\033[35m" << "-- Output:" << "\033[0m" << '\n';
-                while (std::getline(f, buf))
-                    std::cout << buf << '\n';
-                f.close();
+                Preview::print_file(std::cout, out_file, preview_options);
             }
         }
         return 0;
@@ -1,18 +1,165 @@
 #include <iostream>
+#include <cmath>
+#include <ctime>
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <random>
 #include <vector>
-#include <chrono>
 #include <thread>
 #include "fs.h"
 #include "const.h"
 #include "shell.h"
+#include "checker.h"
+#include "interaction.h"
+#include "comparator.h"
+#include "complexity.h"
+#include "hash.h"
+#include "process.h"
+#include "minimizer.h"
+#include "preview.h"
+#include "run_history.h"
+#include "slow_hunter.h"
+#include "statistics.h"
+#include "stress.h"
+#include "test_cache.h"
+#include "test_filter.h"
+#include "test_runner.h"
 
 namespace comproenv {
 
+// Name of test is its path relative to tests directory without extension
+static std::string get_test_name(const fs::path &tests_path, const fs::path &in_file) {
+    std::string name = in_file.string();
+    std::string prefix = tests_path.string();
+    if (name.compare(0, prefix.size(), prefix) == 0 && name.size() > prefix.size())
+        name.erase(0, prefix.size() + 1);
+    if (name.size() >= std::size(".in") - 1 &&
+        name.compare(name.size() - (std::size(".in") - 1), std::string::npos, ".in") == 0)
+        name.erase(name.size() - (std::size(".in") - 1));
+    return name;
+}
+
+// Built-in checkers are "tokens", "float:<epsilon>" and "hash", "plugin:<file>" is a source
+// of checker plugin, any other value of checker setting is a source file of testlib-compatible
+// checker in the task directory that is launched as a separate process
+static bool is_plugin_checker(const std::string &checker) {
+    return checker.compare(0, std::size("plugin:") - 1, "plugin:") == 0;
+}
+
+static bool is_external_checker(const std::string &checker) {
+    return !Checker::create_builtin(checker) && !is_plugin_checker(checker);
+}
+
+// Beginning of captured output without trailing whitespaces
+static std::string read_message(const std::string &path, size_t max_size = 1024) {
+    std::ifstream f(path, std::ios::binary);
+    std::string message(max_size, '\0');
+    f.read(message.data(), (std::streamsize)max_size);
+    message.resize((size_t)f.gcount());
+    while (!message.empty() && std::isspace((unsigned char)message.back()))
+        message.pop_back();
+    return message;
+}
+
+static void print_resources_table(std::ostream &out, const fs::path &tests_path,
+                                  const std::vector <fs::path> &in_files,
+                                  const std::vector <TestRunner::Result> &results) {
+    if (in_files.empty())
+        return;
+    size_t name_width = std::size("Test") - 1;
+    for (auto &in_file : in_files)
+        name_width = std::max(name_width, get_test_name(tests_path, in_file).size());
+    out << "\033[35m" << "-- Resources:" << "\033[0m" << '\n';
+    out << std::left << std::setw((int)name_width) << "Test" << std::right <<
+        " | Verdict |   Wall, s |   User, s | System, s | Memory, MB | Voluntary CS | Involuntary CS\n";
+    std::ios_base::fmtflags flags = out.flags();
+    for (size_t i = 0; i < in_files.size(); ++i) {
+        const ProcessResult &process = results[i].process;
+        out << std::left << std::setw((int)name_width) << get_test_name(tests_path, in_files[i]) << std::right <<
+            " | " << std::setw(7) << (results[i].cached ? "cached" : TestRunner::get_verdict_name(results[i].verdict)) <<
+            std::fixed << std::setprecision(3) <<
+            " | " << std::setw(9) << process.wall_time <<
+            " | " << std::setw(9) << process.user_time <<
+            " | " << std::setw(9) << process.system_time <<
+            " | " << std::setw(10) << std::setprecision(2) << (double)process.peak_memory / (1024 * 1024) <<
+            " | " << std::setw(12) << process.voluntary_context_switches <<
+            " | " << std::setw(14) << process.involuntary_context_switches << '\n';
+        out.flags(flags);
+    }
+}
+
+// Reason why launched solution did not finish successfully, empty if it did
+static std::string get_failure_reason(const ProcessResult &result) {
+    if (!result.launched)
+        return result.error;
+    switch (result.exceeded_limit) {
+    case ProcessResult::Limit::TIME:
+        return "time limit exceeded";
+    case ProcessResult::Limit::MEMORY:
+        return "memory limit exceeded";
+    case ProcessResult::Limit::OUTPUT:
+        return "output limit exceeded";
+    case ProcessResult::Limit::NONE:
+        break;
+    }
+    if (result.exit_code != 0)
+        return "exit code " + std::to_string(result.exit_code);
+    return "";
+}
+
+// Writes <test>.in and <test>.out (if there is an answer)
+static bool save_test(const fs::path &test_path, const std::string &input, const std::optional <std::string> &answer) {
+    std::ofstream in_file(test_path.string() + ".in", std::ios::binary);
+    in_file << input;
+    in_file.close();
+    if (!answer.has_value())
+        return (bool)in_file;
+    std::ofstream out_file(test_path.string() + ".out", std::ios::binary);
+    out_file << answer.value();
+    out_file.close();
+    return in_file && out_file;
+}
+
+// Lines of result and expected around the first mismatched token
+static void print_mismatch(std::ostream &out, const std::string &result_path, const std::string &expected_path,
+                           const TokenComparator::Result &mismatch, int context_lines) {
+    if (context_lines < 0)
+        return;
+    const TokenComparator::Position &result = mismatch.result_position, &expected = mismatch.expected_position;
+    out << "\033[33m";
+    Preview::print_diff(out, {result_path, result.offset, result.line, result.column},
+                        {expected_path, expected.offset, expected.line, expected.column}, context_lines);
+    out << "\033[0m";
+}
+
+static void print_bench_table(std::ostream &out, const SampleStatistics &cpu, const SampleStatistics &wall) {
+    out << "     |   Min, ms | Median, ms |  Mean, ms |   P95, ms | Stddev, ms |     CV\n";
+    std::ios_base::fmtflags flags = out.flags();
+    for (auto [name, statistics] : {std::pair {"CPU ", &cpu}, std::pair {"Wall", &wall}}) {
+        out << name << std::fixed << std::setprecision(3) <<
+            " | " << std::setw(9) << statistics->min * 1000 <<
+            " | " << std::setw(10) << statistics->median * 1000 <<
+            " | " << std::setw(9) << statistics->mean * 1000 <<
+            " | " << std::setw(9) << statistics->p95 * 1000 <<
+            " | " << std::setw(10) << statistics->stddev * 1000 <<
+            " | " << std::setw(5) << std::setprecision(1) << statistics->variation() * 100 << "%\n";
+        out.flags(flags);
+    }
+}
+
 void Shell::configure_commands_task() {
     add_command(State::TASK, "c", "Compile task",
     "ct <- compile task\n"
-    "You can setup compiler using set compiler_<language> <compile_command>\n",
+    "You can setup compiler using set compiler_<language> <compile_command>\n"
+    "External checker (set checker <file>) is compiled too, checker plugin (set checker plugin:<file>) is "
+    "compiled using set compiler_plugin_<language> <compile_command>\n"
+    "Interactor (set interactor <file>) and reference solution (set reference <file>) are compiled too\n",
     [this](std::vector <std::string> &arg) -> int {
         if (arg.size() != 1)
             FAILURE("Incorrect arguments for command " + arg[0]);
@@ -28,14 +175,59 @@ void Shell::configure_commands_task() {
         replace_all(command, "@lang@", current_compiler);
         std::cout << "\033[35m" << "-- Compile task " << envs[current_env].get_tasks()[current_task].get_name() << ":" <<
             "\033[0m\n";
-        auto time_start = std::chrono::high_resolution_clock::now();
         DEBUG_LOG(command);
-        int ret_code = system(command.c_str());
-        auto time_finish = std::chrono::high_resolution_clock::now();
-        std::cout << "\033[35m" << "-- Time elapsed:" <<
-            std::chrono::duration_cast<std::chrono::duration<double>>(time_finish - time_start).count() <<
-            "\033[0m\n";
-        return ret_code;
+        ProcessOptions options;
+        options.command = command;
+        ProcessResult result = Process::run(options);
+        if (!result.launched)
+            FAILURE(result.error);
+        std::cout << "\033[35m" << "-- Time elapsed:" << Process::format_usage(result) << "\033[0m\n";
+        if (result.exit_code != 0)
+            return result.exit_code;
+        // Checker and interactor are compiled alongside the solution
+        struct Helper {
+            std::string kind, source;
+            bool plugin;
+        };
+        std::vector <Helper> helpers;
+        std::string checker = get_setting_by_name("checker").value_or("tokens");
+        if (is_plugin_checker(checker))
+            helpers.push_back({"checker", checker.substr(std::size("plugin:") - 1), true});
+        else if (is_external_checker(checker))
+            helpers.push_back({"checker", checker, false});
+        if (get_setting_by_name("interactor").has_value())
+            helpers.push_back({"interactor", get_setting_by_name("interactor").value(), false});
+        if (get_setting_by_name("reference").has_value())
+            helpers.push_back({"reference solution", get_setting_by_name("reference").value(), false});
+        fs::path task_path = fs::path(env_prefix + envs[current_env].get_name()) /
+            (task_prefix + envs[current_env].get_tasks()[current_task].get_name());
+        for (auto &helper : helpers) {
+            fs::path source = task_path / helper.source;
+            std::string lang = source.extension().string();
+            if (!lang.empty())
+                lang.erase(0, 1);
+            if (!fs::is_regular_file(source))
+                FAILURE("File " + helper.source + " of " + helper.kind + " is not found");
+            std::string compiler = (helper.plugin ? "compiler_plugin_" : "compiler_") + lang;
+            if (!get_setting_by_name(compiler).has_value()) {
+                if (!helper.plugin && get_setting_by_name("runner_" + lang).has_value())
+                    continue;
+                FAILURE("There's no compiler for language " + lang + " (set " + compiler + ")");
+            }
+            command = get_setting_by_name(compiler).value();
+            replace_all(command, "@name@", (task_path / source.stem()).string());
+            replace_all(command, "@lang@", lang);
+            std::cout << "\033[35m" << "-- Compile " << helper.kind << " " << helper.source << ":" << "\033[0m\n";
+            DEBUG_LOG(command);
+            options.command = command;
+            result = Process::run(options);
+            if (!result.launched)
+                FAILURE(result.error);
+            std::cout << "\033[35m" << "-- Time elapsed:" << Process::format_usage(result) << "\033[0m\n";
+            if (result.exit_code != 0)
+                return result.exit_code;
+        }
+        return 0;
     });
 
     add_command(State::TASK, "r", "Run task",
@@ -64,174 +256,520 @@ void Shell::configure_commands_task() {
         replace_all(command, "@lang@", current_runner);
         std::cout << "\033[35m" << "-- Run task " << envs[current_env].get_tasks()[current_task].get_name() << ":" <<
             "\033[0m" << std::endl;
-        auto time_start = std::chrono::high_resolution_clock::now();
         DEBUG_LOG(command);
-        int ret_code = system(command.c_str());
-        auto time_finish = std::chrono::high_resolution_clock::now();
-        std::cout << "\033[35m" << '\n' << "-- Time elapsed:" <<
-            std::chrono::duration_cast<std::chrono::duration<double>>(time_finish - time_start).count() <<
-            "\033[0m" << std::endl;
-        return ret_code;
+        ProcessOptions options;
+        options.command = command;
+        ProcessResult result = Process::run(options);
+        if (!result.launched)
+            FAILURE(result.error);
+        std::cout << "\033[35m" << '\n' << "-- Time elapsed:" << Process::format_usage(result) << "\033[0m" << std::endl;
+        return result.exit_code;
     });
 
     add_command(State::TASK, "t", "Test task",
     "t <- test task\n"
-    "This command launches all available tests and report results of testing\n",
+    "This command launches all available tests and report results of testing\n"
+    "Tests are launched in parallel, number of simultaneous tests can be set using set jobs <count>\n"
+    "Tests that were the longest in the previous run are launched first (set schedule order launches them "
+    "in order of names), with set failed_first on previously failed tests are launched before them, results "
+    "are reported in order of names anyway\n"
+    "Limits for every test can be set using set time_limit <seconds>, set memory_limit <MB>, "
+    "set output_limit <MB>\n"
+    "With set fail_fast_output on the output is compared while the solution is running, "
+    "and the solution is stopped on the first mismatch\n"
+    "Input is given to the solution as an opened file, with set input_pipe on it is fed through a pipe\n"
+    "Output is compared token by token, set checker float:<epsilon> allows absolute or relative error "
+    "of numbers up to epsilon\n"
+    "On mismatch the lines around the first different token of result and expected are shown, their number "
+    "can be set using set diff_context_lines <count> (-1 disables it)\n"
+    "set checker hash compares hashes of tokens, expected output may be replaced by hash of result\n"
+    "set checker <file> uses testlib-compatible checker from the task directory, it is compiled by c command "
+    "and launched as checker <input> <output> <answer>, set checker_time_limit <seconds> limits its CPU time "
+    "(default: 10, 0 means no limit), the test fails if the checker exceeds it\n"
+    "set checker plugin:<file> uses checker plugin (see checker_plugin.h) which is loaded once and called "
+    "in-process\n"
+    "set interactor <file> makes the task interactive: interactor from the task directory is compiled by c "
+    "command and launched as interactor <input> <output>, its stdin and stdout are connected to the solution "
+    "by pipes, the verdict is taken from its exit code\n"
+    "With set interaction_stats on the traffic of interactor and solution is relayed by comproenv, which counts "
+    "exchanges and their round-trip latency (the relay overhead is included) and records the output of "
+    "the solution\n"
+    "With set perf_counters on hardware events (instructions, cycles, branch and cache misses) and software "
+    "events (page faults, task clock) of the solution are counted using perf_event_open (Linux only)\n"
+    "Passed tests are cached: a test is not launched again until the solution, the test or limits change\n"
+    "Launched tests are recorded in the run history of the task, see history-perf command\n"
+    "t --no-cache <- test task ignoring cached results\n"
+    "t --fail-fast <- stop testing at the first failed test (in order of names), running tests are cancelled\n"
+    "t --filter <pattern> <- test only tests with names matching glob pattern (*, ? and [...]), "
+    "can be given several times\n"
+    "t --regex <regex> <- test only tests with names containing a match of regular expression\n"
+    "t --shard <i>/<n> <- test only i-th of n disjoint parts of tests (split by hash of test name), "
+    "e.g. to run tests in several processes\n",
     [this](std::vector <std::string> &arg) -> int {
-        std::string command;
-        std::string path;
-        std::string temp_file_path;
-        std::vector <fs::path> in_files;
-        // Select tests
-        if (arg.size() == 1) { // Run all tests
-            fs::recursive_directory_iterator it_begin(fs::path(env_prefix + envs[current_env].get_name()) /
-                (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests"), it_end;
-            std::copy_if(it_begin, it_end, std::back_inserter(in_files), [](const fs::path &path) {
-                return fs::is_regular_file(path) && path.extension() == ".in";
-            });
-            std::sort(in_files.begin(), in_files.end());
-        } else if (arg.size() > 1) { // Run specific tests
-            for (unsigned i = 1; i < arg.size(); ++i) {
-                fs::path current_test = fs::path(env_prefix + envs[current_env].get_name()) /
-                    (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests" / (arg[i] + ".in");
-                if (fs::is_regular_file(current_test)) {
-                    in_files.emplace_back(current_test);
-                } else {
-                    std::cout << "\033[31mError: Test with name " + arg[i] + " is not found\n\033[0m";
+        bool use_cache = true;
+        auto no_cache_flag = std::remove(arg.begin() + std::min<size_t>(arg.size(), 1), arg.end(), "--no-cache");
+        if (no_cache_flag != arg.end()) {
+            use_cache = false;
+            arg.erase(no_cache_flag, arg.end());
+        }
+        bool fail_fast = false;
+        auto fail_fast_flag = std::remove(arg.begin() + std::min<size_t>(arg.size(), 1), arg.end(), "--fail-fast");
+        if (fail_fast_flag != arg.end()) {
+            fail_fast = true;
+            arg.erase(fail_fast_flag, arg.end());
+        }
+        TestFilter filter;
+        // Arguments are not unquoted by the shell, patterns may be quoted out of habit
+        auto unquote = [](const std::string &value) {
+            if (value.size() >= 2 && (value.front() == '\'' || value.front() == '"') && value.back() == value.front())
+                return value.substr(1, value.size() - 2);
+            return value;
+        };
+        try {
+            for (size_t i = 1; i < arg.size();) {
+                if (arg[i] != "--filter" && arg[i] != "--regex" && arg[i] != "--shard") {
+                    ++i;
+                    continue;
                 }
+                if (i + 1 == arg.size())
+                    FAILURE("Incorrect arguments for command " + arg[0]);
+                if (arg[i] == "--filter")
+                    filter.add_glob(unquote(arg[i + 1]));
+                else if (arg[i] == "--regex")
+                    filter.set_regex(unquote(arg[i + 1]));
+                else
+                    filter.set_shard(arg[i + 1]);
+                arg.erase(arg.begin() + (std::ptrdiff_t)i, arg.begin() + (std::ptrdiff_t)i + 2);
             }
-        } else {
-            FAILURE("Incorrect arguments for command " + arg[0]);
+        } catch (std::regex_error &e) {
+            FAILURE(std::string("Incorrect regular expression: ") + e.what());
+        } catch (std::logic_error &e) {
+            FAILURE(e.what());
+        }
+        fs::path tests_path = fs::path(env_prefix + envs[current_env].get_name()) /
+            (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests";
+        // Select tests
+        std::vector <fs::path> in_files = get_tests(std::vector <std::string>(arg.begin() + 1, arg.end()));
+        if (!filter.empty()) {
+            in_files.erase(std::remove_if(in_files.begin(), in_files.end(), [&](const fs::path &in_file) {
+                return !filter.matches(get_test_name(tests_path, in_file));
+            }), in_files.end());
         }
         // Launch selected tests:
         for (auto &it : in_files)
             std::cout << it << '\n';
+        // Settings are resolved once here, because tests are launched from worker threads
+        std::string current_runner = envs[current_env].get_tasks()[current_task].get_settings()["language"];
+        std::string runner_command = get_runner_command();
+        PreviewOptions preview_options = get_preview_options();
+        int diff_context_lines = (int)get_number_setting("diff_context_lines", 2);
+        TestRunner runner((unsigned)get_number_setting("jobs", 0));
+        ProcessLimits limits = get_process_limits();
+        // External checker that hangs would block the whole testing
+        ProcessLimits checker_limits;
+        checker_limits.time_limit = get_number_setting("checker_time_limit", 10);
+        std::string checker = get_setting_by_name("checker").value_or("tokens");
+        CompareOptions compare_options;
+        if (checker.compare(0, std::size("float:") - 1, "float:") == 0) {
+            try {
+                size_t pos;
+                compare_options.epsilon = std::stod(checker.substr(std::size("float:") - 1), &pos);
+                if (pos != checker.size() - (std::size("float:") - 1) || !(compare_options.epsilon >= 0))
+                    throw std::invalid_argument(checker);
+            } catch (std::exception &) {
+                FAILURE("Incorrect precision in checker " + checker);
+            }
+        }
+        fs::path task_path = fs::path(env_prefix + envs[current_env].get_name()) /
+            (task_prefix + envs[current_env].get_tasks()[current_task].get_name());
+        // External checker is launched as "checker <input> <output> <answer>",
+        // plugin and built-in checkers are called in-process (token checkers read files as streams)
+        bool external_checker = is_external_checker(checker);
+        bool builtin_checker = Checker::create_builtin(checker) != nullptr;
+        std::string checker_command;
+        std::string checker_program;
+        std::unique_ptr <Checker> in_process_checker = get_checker(checker_command, checker_program);
+        // Interactor is launched as "interactor <input> <output>" and talks to the solution through pipes
+        std::optional <std::string> interactor = get_setting_by_name("interactor");
+        std::string interactor_command;
+        std::string interactor_program;
+        if (interactor.has_value()) {
+            #ifdef _WIN32
+            FAILURE("Interactive problems are not supported on Windows");
+            #endif  // _WIN32
+            interactor_command = get_helper_command(interactor.value(), interactor_program);
+            if (!fs::is_regular_file(interactor_program))
+                FAILURE("Interactor " + interactor.value() + " is not found, compile it using c command");
+        }
+        // Results are cached by compiled binary, or by runner and source for interpreted languages,
+        // hash of the solution alone identifies its version in the run history
+        std::string solution_key, solution_version;
+        {
+            Hasher version_hasher;
+            std::string solution_path = (task_path / envs[current_env].get_tasks()[current_task].get_name()).string();
+            if (get_setting_by_name("runner_" + current_runner).has_value()) {
+                version_hasher.update(runner_command);
+                solution_path += "." + current_runner;
+            } else {
+                #ifdef _WIN32
+                solution_path += ".exe";
+                #endif  // _WIN32
+            }
+            bool hashed = version_hasher.update_file(solution_path);
+            if (hashed)
+                solution_version = version_hasher.hex_digest();
+            Hasher hasher;
+            hasher.update(std::to_string(limits.time_limit) + " " + std::to_string(limits.memory_limit) + " " +
+                          std::to_string(limits.output_limit) + " " + checker);
+            hasher.update(version_hasher.digest());
+            if (!builtin_checker)
+                hashed = hashed && hasher.update(checker_command).update_file(checker_program);
+            if (interactor.has_value())
+                hashed = hashed && hasher.update(interactor_command).update_file(interactor_program);
+            if (hashed)
+                solution_key = hasher.hex_digest();
+        }
+        TestCache cache((task_path / test_cache_file_name).string());
+        cache.load();
+        std::vector <std::string> test_keys(in_files.size());
+        int cached_tests = 0;
+        // Tests that were the longest in the previous run are started first, so that a long test started
+        // last does not keep the whole run waiting, tests without history are assumed to be long
+        if (get_setting_by_name("schedule").value_or("longest") == "longest" && in_files.size() > 1) {
+            std::map <std::string, RunRecord> last_runs =
+                RunHistory((task_path / run_history_file_name).string()).load_last_runs();
+            bool failed_first = get_setting_by_name("failed_first").value_or("off") == "on";
+            std::vector <std::pair <bool, double>> priorities;
+            for (const fs::path &in_file : in_files) {
+                auto it = last_runs.find(get_test_name(tests_path, in_file));
+                if (it == last_runs.end())
+                    priorities.emplace_back(failed_first, std::numeric_limits<double>::infinity());
+                else
+                    priorities.emplace_back(failed_first && it->second.verdict != "OK", it->second.wall_time);
+            }
+            std::vector <size_t> order(in_files.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&priorities](size_t a, size_t b) {
+                return priorities[a] > priorities[b];
+            });
+            runner.set_order(order);
+        }
+        // Launched tests are appended to the run history of the task
+        std::vector <RunRecord> history_records;
+        int64_t testing_time = (int64_t)std::time(nullptr);
+        bool fail_fast_output = get_setting_by_name("fail_fast_output").value_or("off") == "on";
+        bool input_pipe = get_setting_by_name("input_pipe").value_or("off") == "on";
+        bool interaction_stats = get_setting_by_name("interaction_stats").value_or("off") == "on";
+        bool perf_counters = get_setting_by_name("perf_counters").value_or("off") == "on";
+        PerfCounts total_perf_counts;
         #ifdef _WIN32
-        path = env_prefix + envs[current_env].get_name() + "\\" +
-            task_prefix + envs[current_env].get_tasks()[current_task].get_name();
-        temp_file_path = path + "\\" + "temp.txt";
-        #else
-        path = env_prefix + envs[current_env].get_name() + "/" +
-            task_prefix + envs[current_env].get_tasks()[current_task].get_name();
-        temp_file_path = path + "/" + "temp.txt";
+        fail_fast_output = false;
+        input_pipe = false;
         #endif  // _WIN32
+        // Output is compared with expected while the solution is running only by token checkers
+        fail_fast_output = fail_fast_output && builtin_checker && checker != "hash" && !interactor.has_value();
         int errors = 0;
         int runtime_errors = 0;
         int mismatched_answers_errors = 0;
-        int error_code = 0;
+        int time_limit_errors = 0;
+        int memory_limit_errors = 0;
+        int output_limit_errors = 0;
+        int presentation_errors = 0;
+        int checker_failures = 0;
+        std::vector <TestRunner::Result> results(in_files.size());
         std::cout << "\033[32m" << "-- Test command" << "\033[0m" << '\n';
-        for (auto &in_file : in_files) {
-            std::cout << "\033[33m" << "-- Test " << in_file << "\033[0m" << '\n';
-            std::cout << "\033[35m" << "-- Input:" << "\033[0m" << '\n';
-            std::string buf;
-            std::ifstream f(in_file);
-            if (!f.is_open())
-                return -1;
-            while (std::getline(f, buf))
-                std::cout << buf << '\n';
-            f.close();
-            std::string current_runner = envs[current_env].get_tasks()[current_task].get_settings()["language"];
-            command = get_setting_by_name("runner_" + current_runner).value_or(
-                #ifdef _WIN32
-                path + "\\" +
-                envs[current_env].get_tasks()[current_task].get_name() + ".exe"
-                #else
-                std::string("./") + path + "/" +
-                envs[current_env].get_tasks()[current_task].get_name()
-                #endif  // _WIN32
-            ) + " < " + in_file.string() + " > " + temp_file_path;
-            replace_all(command, "@name@", (fs::path(env_prefix + envs[current_env].get_name()) /
-                                (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) /
-                                envs[current_env].get_tasks()[current_task].get_name()).string());
-            replace_all(command, "@lang@", current_runner);
-            auto time_start = std::chrono::high_resolution_clock::now();
-            DEBUG_LOG(command);
-            std::cout << "\033[35m" << "-- Result:" << "\033[0m" << std::endl;
-            error_code = system(command.c_str());
-            auto time_finish = std::chrono::high_resolution_clock::now();
-            f.open(temp_file_path);
-            int max_lines_count = std::stoi(get_setting_by_name("max_lines_count").value_or("100"));
-            int max_chars_count = std::stoi(get_setting_by_name("max_chars_count").value_or("-1"));
-            if (max_chars_count == -1) {
-                if (f.is_open()) {
-                    int lines_count = 0;
-                    while (lines_count++ < max_lines_count && std::getline(f, buf))
-                        std::cout << buf << '\n';
-                    if (lines_count == max_lines_count)
-                        std::cout << "...\n";
-                    f.close();
+        size_t reported_tests = runner.run_until(in_files.size(), [&](size_t index, const std::atomic <bool> &cancelled)
+                                                 -> TestRunner::Result {
+            const fs::path &in_file = in_files[index];
+            TestRunner::Result result;
+            std::ostringstream out;
+            if (!solution_key.empty()) {
+                Hasher hasher;
+                hasher.update(solution_key);
+                std::string expected_file = in_file.string();
+                expected_file.replace(expected_file.size() - (std::size(".in") - 1), std::string::npos, ".out");
+                if (hasher.update_file(in_file.string())) {
+                    if (!hasher.update_file(expected_file))
+                        hasher.update(std::string_view("no expected output"));
+                    test_keys[index] = hasher.hex_digest();
                 }
-            } else {
-                if (f.is_open()) {
-                    int lines_count = 0;
-                    int chars_count = 0;
-                    while (lines_count++ < max_lines_count && std::getline(f, buf)) {
-                        for (size_t i = 0; i < buf.size(); ++i) {
-                            if (chars_count >= max_chars_count) {
-                                break;
-                            }
-                            ++chars_count;
-                            std::cout << buf[i] << '\n';
-                        }
-                        if (chars_count >= max_chars_count) {
-                            break;
-                        }
-                    }
-                    if (lines_count == max_lines_count)
-                        std::cout << "...\n";
-                    f.close();
+                if (use_cache && !test_keys[index].empty() &&
+                    cache.contains(get_test_name(tests_path, in_file), test_keys[index])) {
+                    out << "\033[32m" << "-- Test " << in_file << ": cached pass" << "\033[0m" << '\n';
+                    result.cached = true;
+                    result.report = out.str();
+                    return result;
                 }
             }
-            if (error_code) {
-                std::cout << "\033[31m" << "-- Runtime error!" << "\033[0m" << std::endl;
-                ++runtime_errors;
-                ++errors;
+            // Every test writes its result into its own in-memory file
+            OutputCapture capture;
+            const std::string &temp_file_path = capture.get_path();
+            out << "\033[33m" << "-- Test " << in_file << "\033[0m" << '\n';
+            out << "\033[35m" << "-- Input:" << "\033[0m" << '\n';
+            if (!std::ifstream(in_file).is_open()) {
+                out << "\033[31m" << "-- Unable to open test input!" << "\033[0m" << '\n';
+                result.verdict = TestRunner::Verdict::RUNTIME_ERROR;
+                result.report = out.str();
+                return result;
             }
+            Preview::print_file(out, in_file.string(), preview_options);
+            ProcessOptions options;
+            options.command = runner_command;
+            options.stdin_path = in_file.string();
+            options.stdin_pipe = input_pipe;
+            options.stdout_capture = &capture;
+            options.limits = limits;
+            options.perf_counters = perf_counters;
+            // Cancellation is polled while the process runs, so it is requested only when it may happen
+            if (fail_fast)
+                options.cancel = &cancelled;
             std::string out_file = in_file.string();
             for (int i = 0; i < 2; ++i)
                 out_file.pop_back();
             out_file.append("out");
-            f.open(out_file);
-            if (f.is_open()) {
-                std::cout << "\033[35m" << "-- Expected:" << "\033[0m" << '\n';
-                while (std::getline(f, buf))
-                    std::cout << buf << '\n';
-                f.close();
-                std::vector <std::string> res_in, res_out;
-                f.open(temp_file_path, std::ios::in);
-                while (f >> buf) {
-                    res_in.emplace_back(buf);
-                }
-                f.close();
-                f.open(out_file, std::ios::in);
-                while (f >> buf) {
-                    res_out.emplace_back(buf);
+            DEBUG_LOG(runner_command);
+            out << "\033[35m" << "-- Result:" << "\033[0m" << '\n';
+            ProcessResult process_result;
+            std::optional <TokenComparator::Result> comparison;
+            std::optional <InteractionResult> interaction;
+            std::string interactor_message;
+            if (interactor.has_value()) {
+                // Output of the solution is captured to be shown in the report only by the relay
+                OutputCapture interactor_output, interactor_stderr;
+                ProcessOptions interactor_options;
+                interactor_options.command = interactor_command + " \"" + in_file.string() + "\" \"" +
+                    interactor_output.get_path() + "\"";
+                interactor_options.stderr_capture = &interactor_stderr;
+                DEBUG_LOG(interactor_options.command);
+                interaction = Interaction::run(options, interactor_options, interaction_stats, &capture);
+                process_result = interaction->solution;
+                if (!process_result.launched && !interaction->error.empty())
+                    process_result.error = interaction->error;
+                interactor_message = read_message(interactor_stderr.get_path());
+            } else if (fail_fast_output && fs::is_regular_file(out_file)) {
+                // Output goes through a pipe and is compared as soon as it is produced
+                options.stdout_capture = nullptr;
+                options.stdout_pipe = true;
+                Process process(options);
+                if (process.start())
+                    comparison = TokenComparator::compare_running(process, capture, out_file, limits.output_limit,
+                                                                  compare_options);
+                process_result = process.wait();
+            } else {
+                process_result = Process::run(options);
+            }
+            if (!process_result.launched)
+                out << "\033[31m" << "-- " << process_result.error << "\033[0m" << '\n';
+            // Process which was stopped by comproenv did not fail by itself
+            int error_code = process_result.launched ? (process_result.killed ? 0 : process_result.exit_code) : -1;
+            Preview::print_file(out, temp_file_path, preview_options);
+            if (process_result.exceeded_limit == ProcessResult::Limit::TIME) {
+                out << "\033[31m" << "-- Time limit exceeded!" << "\033[0m" << '\n';
+                result.verdict = TestRunner::Verdict::TIME_LIMIT_EXCEEDED;
+            } else if (process_result.exceeded_limit == ProcessResult::Limit::MEMORY) {
+                out << "\033[31m" << "-- Memory limit exceeded!" << "\033[0m" << '\n';
+                result.verdict = TestRunner::Verdict::MEMORY_LIMIT_EXCEEDED;
+            } else if (process_result.exceeded_limit == ProcessResult::Limit::OUTPUT) {
+                out << "\033[31m" << "-- Output limit exceeded!" << "\033[0m" << '\n';
+                result.verdict = TestRunner::Verdict::OUTPUT_LIMIT_EXCEEDED;
+            } else if (error_code) {
+                out << "\033[31m" << "-- Runtime error" <<
+                    (process_result.possibly_out_of_memory ? " (possibly out of memory)" : "") << "!\033[0m" << '\n';
+                result.verdict = TestRunner::Verdict::RUNTIME_ERROR;
+            }
+            // Verdict of interactor, external checker or plugin uses testlib exit codes
+            auto report_checker = [&out, &result](int code, const std::string &message,
+                                                  const char *name = "Checker") {
+                const char *color = "\033[31m";
+                std::string status;
+                switch (code) {
+                case COMPROENV_OK:
+                    color = "\033[32m";
+                    status = "ok";
+                    break;
+                case COMPROENV_WRONG_ANSWER:
+                    status = "wrong answer";
+                    result.verdict = TestRunner::Verdict::MISMATCH;
+                    break;
+                case COMPROENV_PRESENTATION_ERROR:
+                    status = "presentation error";
+                    result.verdict = TestRunner::Verdict::PRESENTATION_ERROR;
+                    break;
+                case COMPROENV_FAIL:
+                    status = "failed";
+                    result.verdict = TestRunner::Verdict::CHECKER_FAILED;
+                    break;
+                default:
+                    status = "failed with exit code " + std::to_string(code);
+                    result.verdict = TestRunner::Verdict::CHECKER_FAILED;
+                    break;
                 }
-                f.close();
-                if (res_in != res_out) {
-                    std::cout << "\033[33;1m" << "-- Warning: Mismatch of result and expected!" << "\033[0m" << std::endl;
-                    if (!error_code) {
-                        ++mismatched_answers_errors;
-                        ++errors;
+                out << color << "-- " << name << ": " << status << "\033[0m" << '\n';
+                if (!message.empty())
+                    out << message << '\n';
+            };
+            if (interaction.has_value()) {
+                // Interactor decides whether the answer is right, unless the solution exceeded a limit
+                if (process_result.launched && interaction->interactor.launched &&
+                    (result.verdict == TestRunner::Verdict::OK || result.verdict == TestRunner::Verdict::RUNTIME_ERROR))
+                    report_checker(interaction->interactor.exit_code, interactor_message, "Interactor");
+                out << "\033[35m" << "-- Interaction: " << Interaction::format_stats(*interaction) << "\033[0m" << '\n';
+            } else if (fs::is_regular_file(out_file)) {
+                out << "\033[35m" << "-- Expected:" << "\033[0m" << '\n';
+                Preview::print_file(out, out_file, preview_options);
+                if (comparison.has_value()) {
+                    // Output was already compared while the solution was running
+                    if (!comparison->equal) {
+                        out << "\033[33;1m" << "-- Warning: Mismatch of result and expected!" << "\033[0m" << '\n';
+                        out << "\033[33m" << "-- First mismatch: " << TokenComparator::describe(*comparison) <<
+                            "\033[0m" << '\n';
+                        print_mismatch(out, temp_file_path, out_file, *comparison, diff_context_lines);
+                        if (process_result.killed && process_result.exceeded_limit == ProcessResult::Limit::NONE)
+                            out << "\033[33m" << "-- Solution was stopped at the first mismatch" << "\033[0m" << '\n';
+                        if (result.verdict == TestRunner::Verdict::OK)
+                            result.verdict = TestRunner::Verdict::MISMATCH;
+                    }
+                } else if (external_checker) {
+                    // Checker is launched only for a solution that has finished successfully
+                    if (result.verdict == TestRunner::Verdict::OK) {
+                        OutputCapture checker_output;
+                        ProcessOptions checker_options;
+                        checker_options.command = checker_command + " \"" + in_file.string() + "\" \"" +
+                            temp_file_path + "\" \"" + out_file + "\"";
+                        checker_options.stdout_capture = &checker_output;
+                        checker_options.stderr_capture = &checker_output;
+                        checker_options.limits = checker_limits;
+                        DEBUG_LOG(checker_options.command);
+                        ProcessResult checker_result = Process::run(checker_options);
+                        if (!checker_result.launched) {
+                            report_checker(COMPROENV_FAIL, checker_result.error);
+                        } else if (checker_result.exceeded_limit == ProcessResult::Limit::TIME) {
+                            std::ostringstream message;
+                            message << "Checker exceeded time limit of " << checker_limits.time_limit <<
+                                " s (see set checker_time_limit)";
+                            report_checker(COMPROENV_FAIL, message.str());
+                        } else {
+                            report_checker(checker_result.exit_code, read_message(checker_output.get_path()));
+                        }
+                    }
+                } else if (builtin_checker && checker != "hash") {
+                    // Token checkers read files as streams, so big outputs are not loaded into memory
+                    TokenComparator::Result mismatch = TokenComparator::compare(temp_file_path, out_file,
+                                                                                compare_options);
+                    if (!mismatch.equal) {
+                        out << "\033[33;1m" << "-- Warning: Mismatch of result and expected!" << "\033[0m" << '\n';
+                        out << "\033[33m" << "-- First mismatch: " << TokenComparator::describe(mismatch) <<
+                            "\033[0m" << '\n';
+                        print_mismatch(out, temp_file_path, out_file, mismatch, diff_context_lines);
+                        if (result.verdict == TestRunner::Verdict::OK)
+                            result.verdict = TestRunner::Verdict::MISMATCH;
+                    }
+                } else if (builtin_checker || result.verdict == TestRunner::Verdict::OK) {
+                    // Plugins and hash checker work on whole files, which are mapped into memory
+                    MappedFile input(in_file.string()), output(temp_file_path), answer(out_file);
+                    Checker::Result check = in_process_checker->check(input.get_buffer(), output.get_buffer(),
+                                                                      answer.get_buffer());
+                    if (!builtin_checker) {
+                        report_checker(check.verdict, check.message);
+                    } else if (check.verdict == COMPROENV_WRONG_ANSWER) {
+                        out << "\033[33;1m" << "-- Warning: Mismatch of result and expected!" << "\033[0m" << '\n';
+                        out << "\033[33m" << "-- " << check.message << "\033[0m" << '\n';
+                        if (result.verdict == TestRunner::Verdict::OK)
+                            result.verdict = TestRunner::Verdict::MISMATCH;
+                    } else if (check.verdict != COMPROENV_OK && result.verdict == TestRunner::Verdict::OK) {
+                        report_checker(check.verdict, check.message);
                     }
                 }
             }
-            std::cout << "\033[35m" << "-- Time elapsed:" <<
-                std::chrono::duration_cast<std::chrono::duration<double>>(time_finish - time_start).count() <<
-                "\033[0m" << std::endl;
-            std::cout << "\033[33m" << "-- End of test " << in_file << "\033[0m" << std::endl;
+            out << "\033[35m" << "-- Time elapsed:" << Process::format_usage(process_result) << "\033[0m" << '\n';
+            if (perf_counters && process_result.launched) {
+                if (process_result.perf_counts.available())
+                    out << "\033[35m" << "-- Perf counters: " << process_result.perf_counts.format() << "\033[0m" << '\n';
+                else
+                    out << "\033[35m" << "-- Perf counters are not available" << "\033[0m" << '\n';
+            }
+            result.process = process_result;
+            out << "\033[33m" << "-- End of test " << in_file << "\033[0m" << '\n';
+            result.report = out.str();
+            return result;
+        }, [fail_fast](const TestRunner::Result &result) {
+            // Interrupted testing (Ctrl-C) is stopped as well
+            return (fail_fast && result.verdict != TestRunner::Verdict::OK) || Process::is_interrupted();
+        }, [&](size_t index, TestRunner::Result &result) {
+            std::cout << result.report << std::flush;
+            results[index] = {result.verdict, {}, result.process, result.cached};
+            if (!result.cached) {
+                total_perf_counts += result.process.perf_counts;
+                if (!solution_version.empty() && result.process.launched)
+                    history_records.push_back({testing_time, solution_version, get_test_name(tests_path, in_files[index]),
+                                               TestRunner::get_verdict_name(result.verdict), result.process.cpu_time,
+                                               result.process.wall_time, result.process.peak_memory});
+            }
+            if (result.cached)
+                ++cached_tests;
+            if (result.verdict == TestRunner::Verdict::RUNTIME_ERROR) {
+                ++runtime_errors;
+                ++errors;
+            } else if (result.verdict == TestRunner::Verdict::MISMATCH) {
+                ++mismatched_answers_errors;
+                ++errors;
+            } else if (result.verdict == TestRunner::Verdict::TIME_LIMIT_EXCEEDED) {
+                ++time_limit_errors;
+                ++errors;
+            } else if (result.verdict == TestRunner::Verdict::MEMORY_LIMIT_EXCEEDED) {
+                ++memory_limit_errors;
+                ++errors;
+            } else if (result.verdict == TestRunner::Verdict::OUTPUT_LIMIT_EXCEEDED) {
+                ++output_limit_errors;
+                ++errors;
+            } else if (result.verdict == TestRunner::Verdict::PRESENTATION_ERROR) {
+                ++presentation_errors;
+                ++errors;
+            } else if (result.verdict == TestRunner::Verdict::CHECKER_FAILED) {
+                ++checker_failures;
+                ++errors;
+            }
+        });
+        if (reported_tests < in_files.size()) {
+            std::cout << "\033[31m" << "-- Testing is " <<
+                (Process::is_interrupted() ? "interrupted" : "stopped after the first failure") << ", " <<
+                in_files.size() - reported_tests << " tests are skipped" << "\033[0m" << '\n';
+            in_files.resize(reported_tests);
+            results.resize(reported_tests);
         }
-        if (std::size(in_files) && remove(temp_file_path.c_str())) {
-            std::cout << "Unable to delete temporary file\n";
+        // Cache is read by worker threads, so it is updated only after all of them are finished
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i].cached || test_keys[i].empty())
+                continue;
+            if (results[i].verdict == TestRunner::Verdict::OK)
+                cache.store(get_test_name(tests_path, in_files[i]), test_keys[i]);
+            else
+                cache.erase(get_test_name(tests_path, in_files[i]));
         }
+        if (!cache.save())
+            std::cout << "\033[31m" << "-- Unable to save test cache" << "\033[0m" << '\n';
+        if (!RunHistory((task_path / run_history_file_name).string()).append(history_records))
+            std::cout << "\033[31m" << "-- Unable to save run history" << "\033[0m" << '\n';
+        print_resources_table(std::cout, tests_path, in_files, results);
+        if (total_perf_counts.available())
+            std::cout << "\033[35m" << "-- Perf counters of all launched tests: " << total_perf_counts.format() <<
+                "\033[0m" << '\n';
         if (errors == 0) {
             std::cout << "\033[32;1m" << "-- Test command: All " << std::size(in_files) <<
-                " tests successfully passed!" << "\033[0m\n";
+                " tests successfully passed";
+            if (cached_tests > 0)
+                std::cout << " (" << cached_tests << " cached)";
+            std::cout << "!" << "\033[0m\n";
         } else {
             std::cout << "\033[31;1m" << "-- Test command: Warning! " << errors <<
                 "/" << std::size(in_files) << " tests failed";
             if (mismatched_answers_errors > 0 ||
-                runtime_errors > 0) {
+                runtime_errors > 0 ||
+                time_limit_errors > 0 ||
+                memory_limit_errors > 0 ||
+                output_limit_errors > 0 ||
+                presentation_errors > 0 ||
+                checker_failures > 0) {
                 std::cout << " (";
                 bool need_space = false;
                 if (mismatched_answers_errors > 0) {
@@ -246,6 +784,36 @@ void Shell::configure_commands_task() {
                     std::cout << runtime_errors << " runtime errors";
                     need_space = true;
                 }
+                if (time_limit_errors > 0) {
+                    if (need_space)
+                        std::cout << ", ";
+                    std::cout << time_limit_errors << " time limit exceeded";
+                    need_space = true;
+                }
+                if (memory_limit_errors > 0) {
+                    if (need_space)
+                        std::cout << ", ";
+                    std::cout << memory_limit_errors << " memory limit exceeded";
+                    need_space = true;
+                }
+                if (output_limit_errors > 0) {
+                    if (need_space)
+                        std::cout << ", ";
+                    std::cout << output_limit_errors << " output limit exceeded";
+                    need_space = true;
+                }
+                if (presentation_errors > 0) {
+                    if (need_space)
+                        std::cout << ", ";
+                    std::cout << presentation_errors << " presentation errors";
+                    need_space = true;
+                }
+                if (checker_failures > 0) {
+                    if (need_space)
+                        std::cout << ", ";
+                    std::cout << checker_failures << " checker failures";
+                    need_space = true;
+                }
                 std::cout << ")";
             }
             std::cout << "!" << "\033[0m\n";
@@ -253,42 +821,608 @@ void Shell::configure_commands_task() {
         return errors;
     });
 
-    add_command(State::TASK, "tf", "Test (stop testing after first failure)",
-    "tf <- test (stop testing after first failure)\n",
+    add_command(State::TASK, "bench", "Benchmark task",
+    "bench <- run every test several times and report statistics of CPU and wall time\n"
+    "bench <test1> <test2> ... <- benchmark specific tests\n"
+    "bench --csv <file> <- benchmark tests and also write statistics to CSV file\n"
+    "Tests are launched one by one, number of warm-up runs (not measured) and measured runs can be set using "
+    "set bench_warmup <count> (default: 1) and set bench_runs <count> (default: 10)\n"
+    "Measurements are reported as unstable when coefficient of variation of CPU or wall time exceeds "
+    "set bench_max_variation <fraction> (default: 0.05)\n",
     [this](std::vector <std::string> &arg) -> int {
-        if (arg.size() != 1)
+        std::string csv_path;
+        std::vector <std::string> names;
+        for (size_t i = 1; i < arg.size(); ++i) {
+            if (arg[i] == "--csv") {
+                if (i + 1 == arg.size())
+                    FAILURE("Incorrect arguments for command " + arg[0]);
+                csv_path = arg[++i];
+            } else {
+                names.push_back(arg[i]);
+            }
+        }
+        std::vector <fs::path> in_files = get_tests(names);
+        if (in_files.empty())
+            FAILURE("There are no tests to benchmark");
+        size_t warmup_runs = (size_t)get_number_setting("bench_warmup", 1);
+        size_t runs = (size_t)get_number_setting("bench_runs", 10);
+        double max_variation = get_number_setting("bench_max_variation", 0.05);
+        if (runs == 0)
+            FAILURE("Number of runs must be positive");
+        std::string runner_command = get_runner_command();
+        ProcessLimits limits = get_process_limits();
+        fs::path tests_path = fs::path(env_prefix + envs[current_env].get_name()) /
+            (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests";
+        std::ofstream csv;
+        if (!csv_path.empty()) {
+            csv.open(csv_path);
+            if (!csv.is_open())
+                FAILURE("Unable to open file " + csv_path);
+            csv << "test,runs,cpu_min,cpu_median,cpu_mean,cpu_p95,cpu_stddev,"
+                   "wall_min,wall_median,wall_mean,wall_p95,wall_stddev,peak_memory,unstable\n";
+            csv << std::setprecision(9);
+        }
+        int failed_tests = 0;
+        int unstable_tests = 0;
+        std::cout << "\033[32m" << "-- Bench command: " << warmup_runs << " warm-up and " << runs <<
+            " measured runs of every test" << "\033[0m" << '\n';
+        for (const fs::path &in_file : in_files) {
+            std::string name = get_test_name(tests_path, in_file);
+            std::vector <double> cpu_times, wall_times;
+            size_t peak_memory = 0;
+            std::string failure;
+            for (size_t run = 0; run < warmup_runs + runs && failure.empty(); ++run) {
+                OutputCapture capture;
+                ProcessOptions options;
+                options.command = runner_command;
+                options.stdin_path = in_file.string();
+                options.stdout_capture = &capture;
+                options.limits = limits;
+                DEBUG_LOG(runner_command);
+                ProcessResult result = Process::run(options);
+                failure = get_failure_reason(result);
+                if (!failure.empty()) {
+                    failure = "run " + std::to_string(run + 1) + " failed: " + failure;
+                } else if (run >= warmup_runs) {
+                    cpu_times.push_back(result.cpu_time);
+                    wall_times.push_back(result.wall_time);
+                    peak_memory = std::max(peak_memory, result.peak_memory);
+                }
+            }
+            if (!failure.empty()) {
+                std::cout << "\033[31m" << "-- Test " << name << ": " << failure << "\033[0m" << '\n';
+                ++failed_tests;
+                continue;
+            }
+            SampleStatistics cpu = SampleStatistics::compute(cpu_times);
+            SampleStatistics wall = SampleStatistics::compute(wall_times);
+            bool unstable = cpu.variation() > max_variation || wall.variation() > max_variation;
+            std::cout << "\033[33m" << "-- Test " << name << ": " << runs << " runs, peak memory " <<
+                std::fixed << std::setprecision(2) << (double)peak_memory / (1024 * 1024) << " MB" <<
+                std::defaultfloat << "\033[0m" << '\n';
+            print_bench_table(std::cout, cpu, wall);
+            if (unstable) {
+                std::cout << "\033[33;1m" << "-- Warning: Unstable measurements (coefficient of variation is above " <<
+                    max_variation * 100 << "%)" << "\033[0m" << '\n';
+                ++unstable_tests;
+            }
+            if (csv.is_open()) {
+                csv << name << ',' << runs << ',' << cpu.min << ',' << cpu.median << ',' << cpu.mean << ',' <<
+                    cpu.p95 << ',' << cpu.stddev << ',' << wall.min << ',' << wall.median << ',' << wall.mean << ',' <<
+                    wall.p95 << ',' << wall.stddev << ',' << peak_memory << ',' << (unstable ? 1 : 0) << '\n';
+            }
+        }
+        if (csv.is_open()) {
+            csv.close();
+            if (!csv)
+                std::cout << "\033[31m" << "-- Unable to write file " << csv_path << "\033[0m" << '\n';
+        }
+        std::cout << (failed_tests > 0 ? "\033[31;1m" : "\033[32;1m") << "-- Bench command: " <<
+            in_files.size() - (size_t)failed_tests << "/" << in_files.size() << " tests measured";
+        if (unstable_tests > 0)
+            std::cout << ", " << unstable_tests << " unstable";
+        std::cout << "\033[0m" << '\n';
+        return failed_tests;
+    });
+
+    add_command(State::TASK, "stress", "Stress test task",
+    "stress <- compare solution with reference solution on 1000 generated tests\n"
+    "stress <iterations> <- compare solution with reference solution on given number of generated tests\n"
+    "stress --seed <seed> --name <test> <- set seed of the first generated test and name of the saved test\n"
+    "Generator of the task (see cg) gets seed as the last argument and prints test to stdout, "
+    "reference solution is set using set reference <file> and compiled by c command\n"
+    "Tests are checked in parallel (see set jobs) until the first failure, which is saved as a test "
+    "with the answer of reference solution (default name: stress_<seed>)\n",
+    [this](std::vector <std::string> &arg) -> int {
+        size_t iterations = 1000;
+        std::optional <uint64_t> first_seed;
+        std::string test_name;
+        try {
+            for (size_t i = 1; i < arg.size(); ++i) {
+                if ((arg[i] == "--seed" || arg[i] == "--name") && i + 1 == arg.size())
+                    throw std::invalid_argument(arg[i]);
+                size_t pos = 0;
+                if (arg[i] == "--seed") {
+                    first_seed = std::stoull(arg[++i], &pos);
+                    if (pos != arg[i].size())
+                        throw std::invalid_argument(arg[i]);
+                } else if (arg[i] == "--name") {
+                    test_name = arg[++i];
+                } else {
+                    iterations = std::stoull(arg[i], &pos);
+                    if (pos != arg[i].size() || iterations == 0)
+                        throw std::invalid_argument(arg[i]);
+                }
+            }
+        } catch (std::logic_error &) {
             FAILURE("Incorrect arguments for command " + arg[0]);
-        std::vector <std::string> args;
-        args.push_back("t");
-        std::vector <fs::path> in_files;
-        fs::recursive_directory_iterator it_begin(fs::path(env_prefix + envs[current_env].get_name()) /
-            (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests"), it_end;
-        std::copy_if(it_begin, it_end, std::back_inserter(in_files), [](const fs::path &path) {
-            return fs::is_regular_file(path) && path.extension() == ".in";
+        }
+        if (!get_setting_by_name("reference").has_value())
+            FAILURE("There's no reference solution, set it using set reference <file>");
+        std::unique_ptr <Checker> checker;
+        StressOptions options = get_stress_options(checker);
+        options.generator_command = get_generator_command();
+        if (!first_seed.has_value())
+            first_seed = std::random_device()();
+        PreviewOptions preview_options = get_preview_options();
+        std::cout << "\033[32m" << "-- Stress command: " << iterations << " tests from seed " << first_seed.value() <<
+            "\033[0m" << '\n';
+        StressTester tester(options);
+        double start_time = Process::current_time();
+        StressTester::Result result = tester.run(first_seed.value(), iterations, (unsigned)get_number_setting("jobs", 0),
+                                                 [](size_t finished) {
+            std::cout << "\r-- Tests: " << finished << std::flush;
         });
-        std::sort(in_files.begin(), in_files.end());
-        std::vector <std::string> test_names;
-        for (const fs::path &path : in_files) {
-            std::string test_name = path.filename().string();
-            test_names.push_back(std::string(test_name.begin(), test_name.end() - std::size(".in") + 1));
-        }
-        int index = 0;
-        int res = 0;
-        for (const std::string_view test : test_names) {
-            args.emplace_back(test);
-            res = commands[current_state]["t"](args);
-            if (res != 0) {
-                std::cout << "\033[31m" << "-- Test failed! Stopped running tests. "
-                        << index << " of " << test_names.size()
-                        << " tests passed before failure" << "\033[0m" << '\n';
-                return 1;
+        double elapsed = Process::current_time() - start_time;
+        std::cout << "\r-- Tests: " << result.iterations << " in " << std::fixed << std::setprecision(2) << elapsed <<
+            " s (" << std::setprecision(0) << (double)result.iterations / std::max(elapsed, 1e-9) << " per second)" <<
+            std::defaultfloat << '\n';
+        if (!result.error.empty())
+            FAILURE(result.error);
+        if (!result.failure.has_value()) {
+            std::cout << "\033[32;1m" << "-- Stress command: Solution agrees with reference solution on all " <<
+                result.iterations << " tests!" << "\033[0m" << '\n';
+            return 0;
+        }
+        const StressCase &failure = result.failure.value();
+        std::cout << "\033[31m" << "-- Test with seed " << result.seed << " failed: " <<
+            TestRunner::get_verdict_name(failure.verdict) << "\033[0m" << '\n';
+        if (!failure.message.empty())
+            std::cout << "\033[33m" << "-- " << failure.message << "\033[0m" << '\n';
+        std::cout << "\033[35m" << "-- Input:" << "\033[0m" << '\n';
+        Preview::print_text(std::cout, failure.input, preview_options);
+        std::cout << "\033[35m" << "-- Result:" << "\033[0m" << '\n';
+        Preview::print_text(std::cout, failure.output, preview_options);
+        std::cout << "\033[35m" << "-- Expected:" << "\033[0m" << '\n';
+        Preview::print_text(std::cout, failure.answer, preview_options);
+        if (test_name.empty())
+            test_name = "stress_" + std::to_string(result.seed);
+        fs::path tests_path = fs::path(env_prefix + envs[current_env].get_name()) /
+            (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests";
+        if (!save_test(tests_path / test_name, failure.input, failure.answer))
+            FAILURE("Unable to save test " + test_name);
+        std::cout << "\033[31;1m" << "-- Stress command: Failed test is saved as " << test_name << "\033[0m" << '\n';
+        return 1;
+    });
+
+    add_command(State::TASK, "minimize", "Minimize failed test",
+    "minimize <test> <- reduce test on which the solution fails and save the result as <test>_min\n"
+    "minimize <test> --name <new_test> <- reduce test and save the result as <new_test>\n"
+    "Lines and tokens are removed and numbers are shrunk while the solution fails with the same verdict, "
+    "candidates are checked in parallel (see set jobs), their stderr is shown only for the reduced test\n"
+    "Wrong answers are detected by comparison with reference solution (set reference <file>), it also "
+    "gives the expected output of the reduced test, without it only runtime errors and exceeded limits "
+    "are detected\n",
+    [this](std::vector <std::string> &arg) -> int {
+        if (arg.size() != 2 && !(arg.size() == 4 && arg[2] == "--name"))
+            FAILURE("Incorrect arguments for command " + arg[0]);
+        fs::path tests_path = fs::path(env_prefix + envs[current_env].get_name()) /
+            (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests";
+        std::string test_name = arg.size() == 4 ? arg[3] : arg[1] + "_min";
+        std::ifstream f(tests_path / (arg[1] + ".in"), std::ios::binary);
+        if (!f.is_open())
+            FAILURE("Test with name " + arg[1] + " is not found");
+        std::string input((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        f.close();
+        std::unique_ptr <Checker> checker;
+        StressOptions options = get_stress_options(checker);
+        // Crashing candidates would flood the terminal, stderr is shown only for the reduced test
+        options.capture_stderr = true;
+        StressTester tester(options);
+        StressCase original = tester.check(input);
+        if (!original.valid)
+            FAILURE(original.message);
+        if (original.verdict == TestRunner::Verdict::OK)
+            FAILURE("Solution does not fail on test " + arg[1] + (options.reference_command.empty() ?
+                    " (set reference <file> to detect wrong answers)" : ""));
+        std::cout << "\033[32m" << "-- Minimize command: test " << arg[1] << " (" << input.size() << " bytes) fails with " <<
+            TestRunner::get_verdict_name(original.verdict) << "\033[0m" << '\n';
+        Minimizer minimizer([&](const std::string &candidate) {
+            StressCase test = tester.check(candidate);
+            return test.valid && test.verdict == original.verdict;
+        }, (unsigned)get_number_setting("jobs", 0));
+        double start_time = Process::current_time();
+        std::string reduced = minimizer.minimize(input, [](size_t size) {
+            std::cout << "\r-- Size: " << size << " bytes" << std::flush;
+        });
+        std::cout << "\r-- Reduced from " << input.size() << " to " << reduced.size() << " bytes using " <<
+            minimizer.get_evaluations() << " runs in " << std::fixed << std::setprecision(2) <<
+            Process::current_time() - start_time << " s" << std::defaultfloat << '\n';
+        StressCase result = tester.check(reduced);
+        PreviewOptions preview_options = get_preview_options();
+        std::cout << "\033[35m" << "-- Input:" << "\033[0m" << '\n';
+        Preview::print_text(std::cout, reduced, preview_options);
+        std::cout << "\033[35m" << "-- Result:" << "\033[0m" << '\n';
+        Preview::print_text(std::cout, result.output, preview_options);
+        if (!result.errors.empty()) {
+            std::cout << "\033[35m" << "-- Stderr:" << "\033[0m" << '\n';
+            Preview::print_text(std::cout, result.errors, preview_options);
+        }
+        if (!result.message.empty())
+            std::cout << "\033[33m" << "-- " << result.message << "\033[0m" << '\n';
+        std::optional <std::string> answer;
+        if (!options.reference_command.empty()) {
+            answer = result.answer;
+            std::cout << "\033[35m" << "-- Expected:" << "\033[0m" << '\n';
+            Preview::print_text(std::cout, result.answer, preview_options);
+        }
+        if (!save_test(tests_path / test_name, reduced, answer))
+            FAILURE("Unable to save test " + test_name);
+        std::cout << "\033[32;1m" << "-- Minimize command: Reduced test is saved as " << test_name << "\033[0m" << '\n';
+        return 0;
+    });
+
+    add_command(State::TASK, "complexity", "Estimate complexity of solution",
+    "complexity <min size> <max size> <- run the solution on generated tests of sizes from min to max "
+    "and fit the times to complexity classes\n"
+    "complexity <min size> <max size> --constraint <size> <- also estimate time for the maximal size "
+    "from the statement (default: max size)\n"
+    "Generator of the task (see cg) gets size and seed as the last two arguments and prints test to stdout\n"
+    "Sizes grow geometrically, their number and the number of runs of every size can be set using "
+    "set complexity_steps <count> (default: 6) and set complexity_runs <count> (default: 3), runs are "
+    "launched in parallel (see set jobs) and the median CPU time of every size is fitted\n",
+    [this](std::vector <std::string> &arg) -> int {
+        std::vector <double> bounds;
+        std::optional <double> constraint;
+        try {
+            for (size_t i = 1; i < arg.size(); ++i) {
+                bool is_constraint = arg[i] == "--constraint";
+                if (is_constraint && ++i == arg.size())
+                    throw std::invalid_argument(arg[i - 1]);
+                size_t pos = 0;
+                double value = std::stod(arg[i], &pos);
+                if (pos != arg[i].size() || !(value >= 1))
+                    throw std::invalid_argument(arg[i]);
+                if (is_constraint)
+                    constraint = value;
+                else
+                    bounds.push_back(value);
             }
-            ++index;
-            args.pop_back();
+        } catch (std::logic_error &) {
+            FAILURE("Incorrect arguments for command " + arg[0]);
         }
-        std::cout << "\033[32m" << "-- All " << std::size(in_files) <<
-            " tests successfully passed!" << "\033[0m\n";
-        return res;
+        if (bounds.size() != 2 || bounds[0] >= bounds[1])
+            FAILURE("Incorrect arguments for command " + arg[0]);
+        size_t steps = (size_t)get_number_setting("complexity_steps", 6);
+        size_t runs = (size_t)get_number_setting("complexity_runs", 3);
+        if (steps < 3 || runs == 0)
+            FAILURE("At least 3 sizes and 1 run are required");
+        std::vector <uint64_t> sizes;
+        for (size_t i = 0; i < steps; ++i) {
+            double ratio = std::pow(bounds[1] / bounds[0], (double)i / (double)(steps - 1));
+            uint64_t size = (uint64_t)std::llround(bounds[0] * ratio);
+            if (sizes.empty() || size > sizes.back())
+                sizes.push_back(size);
+        }
+        std::unique_ptr <Checker> checker;
+        StressOptions options = get_stress_options(checker);
+        // Only the time of the solution is measured
+        options.reference_command.clear();
+        options.generator_command = get_generator_command();
+        StressTester tester(options);
+        TestRunner runner((unsigned)get_number_setting("jobs", 0));
+        std::cout << "\033[32m" << "-- Complexity command: " << sizes.size() << " sizes from " << sizes.front() <<
+            " to " << sizes.back() << ", " << runs << " runs of every size" << "\033[0m" << '\n';
+        std::vector <OutputCapture> inputs(sizes.size());
+        std::vector <std::string> errors(sizes.size());
+        runner.run(sizes.size(), [&](size_t index) {
+            tester.generate(std::to_string(sizes[index]) + " 1", inputs[index], errors[index]);
+            return TestRunner::Result();
+        }, [](size_t, TestRunner::Result &) {});
+        for (const std::string &error : errors)
+            if (!error.empty())
+                FAILURE(error);
+        std::vector <std::vector <double>> times(sizes.size());
+        std::vector <std::string> failures(sizes.size());
+        runner.run(sizes.size() * runs, [&](size_t index) {
+            StressCase test = tester.check(inputs[index / runs]);
+            TestRunner::Result result;
+            result.verdict = test.verdict;
+            result.report = test.message;
+            result.process = test.solution;
+            return result;
+        }, [&](size_t index, TestRunner::Result &result) {
+            std::cout << "\r-- Runs: " << index + 1 << "/" << sizes.size() * runs << std::flush;
+            if (result.verdict == TestRunner::Verdict::OK)
+                times[index / runs].push_back(result.process.cpu_time);
+            else if (failures[index / runs].empty())
+                failures[index / runs] = TestRunner::get_verdict_name(result.verdict) +
+                    (result.report.empty() ? "" : ": " + result.report);
+        });
+        std::cout << '\n' << "Size         |  Input, KB | Median, ms |    Min, ms |    Max, ms\n";
+        std::vector <double> measured_sizes, measured_times;
+        double max_time = 0;
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            std::cout << std::left << std::setw(12) << sizes[i] << std::right << " | " << std::setw(10) <<
+                std::fixed << std::setprecision(1) << (double)fs::file_size(inputs[i].get_path()) / 1024;
+            if (!failures[i].empty()) {
+                std::cout << " | " << "\033[31m" << failures[i] << "\033[0m" << std::defaultfloat << '\n';
+                continue;
+            }
+            SampleStatistics statistics = SampleStatistics::compute(times[i]);
+            std::cout << std::setprecision(3) << " | " << std::setw(10) << statistics.median * 1000 <<
+                " | " << std::setw(10) << statistics.min * 1000 << " | " << std::setw(10) << statistics.max * 1000 <<
+                std::defaultfloat << '\n';
+            measured_sizes.push_back((double)sizes[i]);
+            measured_times.push_back(statistics.median);
+            max_time = std::max(max_time, statistics.median);
+        }
+        if (measured_sizes.size() < 3)
+            FAILURE("Solution failed on too many sizes, at least 3 measured sizes are required");
+        std::vector <ComplexityFit> fits = Complexity::fit(measured_sizes, measured_times);
+        std::cout << "\033[35m" << "-- Fits (relative error):" << "\033[0m" << '\n';
+        for (size_t i = 0; i < std::min<size_t>(fits.size(), 4); ++i)
+            std::cout << std::left << std::setw(13) << fits[i].name << std::right << " | " << std::fixed <<
+                std::setprecision(1) << std::setw(6) << fits[i].error * 100 << "%" << std::defaultfloat << '\n';
+        if (max_time < 0.01)
+            std::cout << "\033[33;1m" << "-- Warning: Measured times are too small for reliable estimation, "
+                "increase sizes" << "\033[0m" << '\n';
+        if (measured_sizes.size() < sizes.size())
+            std::cout << "\033[33;1m" << "-- Warning: Solution failed on " << sizes.size() - measured_sizes.size() <<
+                " sizes, they are not fitted" << "\033[0m" << '\n';
+        double target = constraint.value_or((double)sizes.back());
+        double estimate = fits.front().predict(target);
+        ProcessLimits limits = get_process_limits();
+        std::cout << (limits.time_limit > 0 && estimate > limits.time_limit ? "\033[31;1m" : "\033[32;1m") <<
+            "-- Complexity command: Best fit is " << fits.front().name << ", estimated CPU time for size " <<
+            std::setprecision(15) << target << " is " << std::setprecision(3) << estimate << " s";
+        if (limits.time_limit > 0)
+            std::cout << " (time limit " << limits.time_limit << " s)";
+        std::cout << std::defaultfloat << "\033[0m" << '\n';
+        return 0;
+    });
+
+    add_command(State::TASK, "hunt-slow", "Search for slow tests",
+    "hunt-slow <- search for arguments of the generator on which the solution is the slowest using 200 runs\n"
+    "hunt-slow <runs> --param <min>:<max> ... <- search using given number of runs, integer parameters from "
+    "the ranges are given to the generator before the seed\n"
+    "hunt-slow --keep <count> --seed <seed> --name <prefix> <- set the number of saved tests (default: 5), "
+    "the seed of the search and the prefix of names of saved tests (default: slow)\n"
+    "New arguments are mutations of the slowest ones found so far (or random ones), candidates are checked in "
+    "parallel (see set jobs), the slowest inputs are saved as tests <prefix>_1, <prefix>_2, ... with the answer "
+    "of reference solution if it is set\n"
+    "CPU time of the solution is maximized, with set perf_counters on the number of instructions is used "
+    "if hardware counters are available\n",
+    [this](std::vector <std::string> &arg) -> int {
+        size_t evaluations = 200;
+        HuntOptions hunt_options;
+        std::optional <uint64_t> seed;
+        std::string prefix = "slow";
+        try {
+            for (size_t i = 1; i < arg.size(); ++i) {
+                if ((arg[i] == "--param" || arg[i] == "--keep" || arg[i] == "--seed" || arg[i] == "--name") &&
+                    i + 1 == arg.size())
+                    throw std::invalid_argument(arg[i]);
+                size_t pos = 0;
+                if (arg[i] == "--param") {
+                    std::string range = arg[++i];
+                    size_t colon = range.find(':');
+                    if (colon == std::string::npos)
+                        throw std::invalid_argument(range);
+                    int64_t low = std::stoll(range.substr(0, colon), &pos);
+                    if (pos != colon)
+                        throw std::invalid_argument(range);
+                    int64_t high = std::stoll(range.substr(colon + 1), &pos);
+                    if (pos != range.size() - colon - 1 || low > high)
+                        throw std::invalid_argument(range);
+                    hunt_options.parameters.emplace_back(low, high);
+                    continue;
+                }
+                if (arg[i] == "--name") {
+                    prefix = arg[++i];
+                    continue;
+                }
+                bool is_option = arg[i] == "--keep" || arg[i] == "--seed";
+                uint64_t value = std::stoull(arg[i + is_option], &pos);
+                if (pos != arg[i + is_option].size())
+                    throw std::invalid_argument(arg[i]);
+                if (arg[i] == "--keep")
+                    hunt_options.keep = value;
+                else if (arg[i] == "--seed")
+                    seed = value;
+                else
+                    evaluations = value;
+                i += is_option;
+            }
+        } catch (std::logic_error &) {
+            FAILURE("Incorrect arguments for command " + arg[0]);
+        }
+        if (evaluations == 0 || hunt_options.keep == 0)
+            FAILURE("Incorrect arguments for command " + arg[0]);
+        std::unique_ptr <Checker> checker;
+        StressOptions options = get_stress_options(checker);
+        // Answers are needed only for the saved tests
+        std::string reference_command = options.reference_command;
+        options.reference_command.clear();
+        options.generator_command = get_generator_command();
+        hunt_options.instructions = get_setting_by_name("perf_counters").value_or("off") == "on";
+        options.perf_counters = hunt_options.instructions;
+        if (!seed.has_value())
+            seed = std::random_device()();
+        std::cout << "\033[32m" << "-- Hunt-slow command: " << evaluations << " runs with " <<
+            hunt_options.parameters.size() << " parameters from seed " << seed.value() << "\033[0m" << '\n';
+        SlowHunter hunter(options, hunt_options);
+        double start_time = Process::current_time();
+        SlowHunter::Result result = hunter.run(seed.value(), evaluations, (unsigned)get_number_setting("jobs", 0),
+                                               [](size_t finished, double slowest) {
+            std::cout << "\r-- Runs: " << finished << ", slowest: " << std::fixed << std::setprecision(3) <<
+                slowest * 1000 << " ms" << std::defaultfloat << std::flush;
+        });
+        std::cout << "\r-- Runs: " << result.evaluations << " in " << std::fixed << std::setprecision(2) <<
+            Process::current_time() - start_time << " s" << std::defaultfloat << "\033[K" << '\n';
+        if (!result.error.empty())
+            FAILURE(result.error);
+        if (result.failures > 0)
+            std::cout << "\033[33;1m" << "-- Warning: Solution failed on " << result.failures <<
+                " inputs (not time limit), use stress command to find them" << "\033[0m" << '\n';
+        if (hunt_options.instructions && !result.instructions)
+            std::cout << "\033[33m" << "-- Instructions are not counted, CPU time is used instead" << "\033[0m" << '\n';
+        if (result.slowest.empty())
+            FAILURE("Solution failed on all inputs");
+        fs::path tests_path = fs::path(env_prefix + envs[current_env].get_name()) /
+            (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests";
+        StressTester tester(options);
+        std::cout << "Test" << std::string(std::max<size_t>(prefix.size() + 3, 4) - 4, ' ') <<
+            " | Verdict |   CPU, ms | " << (result.instructions ? "  Instructions | " : "") << "Arguments\n";
+        for (size_t i = 0; i < result.slowest.size(); ++i) {
+            const HuntCandidate &candidate = result.slowest[i];
+            std::string test_name = prefix + "_" + std::to_string(i + 1);
+            OutputCapture input;
+            std::string error;
+            if (!tester.generate(candidate.get_arguments(), input, error))
+                FAILURE(error);
+            std::optional <std::string> answer;
+            if (!reference_command.empty()) {
+                OutputCapture reference_output;
+                ProcessOptions reference_options;
+                reference_options.command = reference_command;
+                reference_options.stdin_path = input.get_path();
+                reference_options.stdout_capture = &reference_output;
+                ProcessResult reference = Process::run(reference_options);
+                if (!reference.launched || reference.exit_code != 0)
+                    FAILURE("Reference solution failed on arguments " + candidate.get_arguments() + ": " +
+                            (reference.launched ? "exit code " + std::to_string(reference.exit_code) : reference.error));
+                answer = StressTester::read_capture(reference_output);
+            }
+            if (!save_test(tests_path / test_name, StressTester::read_capture(input), answer))
+                FAILURE("Unable to save test " + test_name);
+            std::cout << std::left << std::setw((int)std::max<size_t>(prefix.size() + 3, 4)) << test_name <<
+                std::right << " | " << std::setw(7) << TestRunner::get_verdict_name(candidate.test.verdict) <<
+                " | " << std::setw(9) << std::fixed << std::setprecision(3) << candidate.test.solution.cpu_time * 1000 <<
+                std::defaultfloat;
+            if (result.instructions)
+                std::cout << " | " << std::setw(13) << candidate.test.solution.perf_counts.values[PerfCounts::INSTRUCTIONS];
+            std::cout << " | " << candidate.get_arguments() << '\n';
+        }
+        std::cout << "\033[32;1m" << "-- Hunt-slow command: " << result.slowest.size() << " slowest inputs are saved as " <<
+            prefix << "_1.." << prefix << "_" << result.slowest.size() << "\033[0m" << '\n';
+        return 0;
+    });
+
+    add_command(State::TASK, "history-perf", "Show timing trends of tests",
+    "history-perf <- show median CPU time of every test for the last versions of the solution\n"
+    "history-perf <test1> <test2> ... <- show trends of selected tests\n"
+    "history-perf --threshold <percent> <- report tests which became slower by more than percent\n"
+    "Every launched test is recorded by t command in the run history of the task, only passed runs are counted\n"
+    "Versions of the solution are hashes of its compiled binary (of its source for interpreted languages), "
+    "so a rebuild with other compiler flags is a new version too\n"
+    "Test is reported as regressed if its median CPU time with the last version is greater than with the "
+    "previous version by more than set regression_threshold <percent> (default: 10) and by at least 1 ms\n",
+    [this](std::vector <std::string> &arg) -> int {
+        double threshold = get_number_setting("regression_threshold", 10);
+        std::vector <std::string> names;
+        for (size_t i = 1; i < arg.size(); ++i) {
+            if (arg[i] == "--threshold") {
+                if (++i == arg.size())
+                    FAILURE("Incorrect arguments for command " + arg[0] + ": threshold is not given");
+                try {
+                    size_t pos = 0;
+                    threshold = std::stod(arg[i], &pos);
+                    if (pos != arg[i].size() || !(threshold >= 0))
+                        throw std::invalid_argument(arg[i]);
+                } catch (std::exception &) {
+                    FAILURE("Incorrect threshold " + arg[i]);
+                }
+            } else {
+                names.push_back(arg[i]);
+            }
+        }
+        fs::path task_path = fs::path(env_prefix + envs[current_env].get_name()) /
+            (task_prefix + envs[current_env].get_tasks()[current_task].get_name());
+        std::vector <RunRecord> records;
+        if (!RunHistory((task_path / run_history_file_name).string()).load(records) || records.empty())
+            FAILURE("Run history is empty, launch tests using t command");
+        std::vector <TestTrend> trends = RunHistory::get_trends(records);
+        if (!names.empty()) {
+            trends.erase(std::remove_if(trends.begin(), trends.end(), [&names](const TestTrend &trend) {
+                return std::find(names.begin(), names.end(), trend.test) == names.end();
+            }), trends.end());
+            if (trends.empty())
+                FAILURE("There are no passed runs of selected tests in the run history");
+        }
+        static const size_t trend_versions = 5;
+        size_t name_width = std::size("Test") - 1;
+        for (const TestTrend &trend : trends)
+            name_width = std::max(name_width, trend.test.size());
+        time_t first_run = (time_t)records.front().timestamp;
+        std::cout << "\033[35m" << "-- Run history: " << records.size() << " runs since " <<
+            std::put_time(localtime(&first_run), "%Y-%m-%d %H:%M:%S") << "\033[0m" << '\n';
+        std::cout << std::left << std::setw((int)name_width) << "Test" << std::right <<
+            " | Versions |  Runs | Previous, ms | Current, ms |   Change | Memory, MB | Trend of last versions, ms\n";
+        int regressions = 0;
+        for (const TestTrend &trend : trends) {
+            std::cout << std::left << std::setw((int)name_width) << trend.test << std::right << std::fixed <<
+                " | " << std::setw(8) << trend.versions.size();
+            if (trend.versions.empty()) {
+                std::cout << " | " << std::setw(5) << 0 << " | (no passed runs)\n" << std::defaultfloat;
+                continue;
+            }
+            const VersionTiming &current = trend.versions.back();
+            bool has_previous = trend.versions.size() > 1;
+            double previous_time = has_previous ? trend.versions[trend.versions.size() - 2].median_cpu_time : 0;
+            bool regressed = has_previous && trend.change() * 100 > threshold &&
+                current.median_cpu_time - previous_time >= 0.001;
+            std::ostringstream previous, change;
+            if (has_previous)
+                previous << std::fixed << std::setprecision(3) << previous_time * 1000;
+            if (has_previous && previous_time > 0)
+                change << std::showpos << std::fixed << std::setprecision(1) << trend.change() * 100 << "%";
+            if (previous.str().empty())
+                previous << "-";
+            if (change.str().empty())
+                change << "-";
+            std::cout << " | " << std::setw(5) << current.runs << std::setprecision(3) <<
+                " | " << std::setw(12) << previous.str() <<
+                " | " << std::setw(11) << current.median_cpu_time * 1000 <<
+                " | " << (regressed ? "\033[31;1m" : "") << std::setw(8) << change.str() << (regressed ? "\033[0m" : "") <<
+                " | " << std::setw(10) << std::setprecision(2) << (double)current.peak_memory / (1024 * 1024) << " |";
+            std::cout << std::setprecision(3);
+            for (size_t i = trend.versions.size() - std::min(trend.versions.size(), trend_versions);
+                 i < trend.versions.size(); ++i)
+                std::cout << ' ' << trend.versions[i].median_cpu_time * 1000;
+            std::cout << std::defaultfloat << '\n';
+            regressions += regressed;
+        }
+        if (regressions > 0) {
+            std::cout << "\033[31;1m" << "-- History-perf command: " << regressions << " tests became slower by more than " <<
+                threshold << "%" << "\033[0m" << '\n';
+            return 1;
+        }
+        std::cout << "\033[32;1m" << "-- History-perf command: No regressions by more than " << threshold << "%" <<
+            "\033[0m" << '\n';
+        return 0;
+    });
+
+    add_command(State::TASK, "tf", "Test (stop testing after first failure)",
+    "tf <- test (stop testing after first failure), the same as t --fail-fast\n"
+    "tf <test1> <test2> ... <- test specific tests until the first failure\n"
+    "tf --filter <pattern> / --regex <regex> / --shard <i>/<n> / --no-cache <- select tests and "
+    "ignore cached results as in t command\n",
+    [this](std::vector <std::string> &arg) -> int {
+        std::vector <std::string> args = arg;
+        args[0] = "t";
+        args.push_back("--fail-fast");
+        return commands[current_state]["t"](args);
     });
 
     add_command(State::TASK, "ee", "Edit task",
@@ -546,26 +1680,20 @@ void Shell::configure_commands_task() {
         std::sort(in_files.begin(), in_files.end());
         std::cout << "\033[32m" << "List of tests for task " <<
             envs[current_env].get_tasks()[current_task].get_name() << "\033[0m" << '\n';
+        PreviewOptions preview_options = get_preview_options();
         for (auto &in_file : in_files) {
             std::cout << "\033[33m" << "Test " << in_file << "\033[0m" << '\n';
             std::cout << "\033[35m" << "-- Input:" << "\033[0m" << '\n';
-            std::string buf;
-            std::ifstream f(in_file);
-            if (!f.is_open())
+            if (!std::ifstream(in_file).is_open())
                 return -1;
-            while (std::getline(f, buf))
-                std::cout << buf << '\n';
-            f.close();
+            Preview::print_file(std::cout, in_file.string(), preview_options);
             std::string out_file = in_file.string();
             out_file.pop_back();
             out_file.pop_back();
             out_file += "out";
-            f.open(out_file);
-            if (f.is_open()) {
+            if (fs::is_regular_file(out_file)) {
                 std::cout << "\033[35m" << "-- Output:" << "\033[0m" << '\n';
-                while (std::getline(f, buf))
-                    std::cout << buf << '\n';
-                f.close();
+                Preview::print_file(std::cout, out_file, preview_options);
             }
         }
         return 0;
@@ -691,43 +1819,22 @@ void Shell::configure_commands_task() {
     });
 
     add_command(State::TASK, "catf", "Compile & Test (stop testing after first failure)",
-    "catf <- compile and test (stop testing after first failure)\n",
+    "catf <- compile and test until the first failed test (in order of names), the same as c followed by "
+    "t --fail-fast, running tests are cancelled\n"
+    "catf <test1> <test2> ... <- compile and test specific tests until the first failure\n"
+    "catf --filter <pattern> / --regex <regex> / --shard <i>/<n> / --no-cache <- select tests and "
+    "ignore cached results as in t command\n",
     [this](std::vector <std::string> &arg) -> int {
-        if (arg.size() != 1)
-            FAILURE("Incorrect arguments for command " + arg[0]);
         std::vector <std::string> args;
         args.push_back("c");
         int res = commands[current_state]["c"](args);
         if (res == 0) {
             args.pop_back();
             args.push_back("t");
-            std::vector <fs::path> in_files;
-            fs::recursive_directory_iterator it_begin(fs::path(env_prefix + envs[current_env].get_name()) /
-                (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests"), it_end;
-            std::copy_if(it_begin, it_end, std::back_inserter(in_files), [](const fs::path &path) {
-                return fs::is_regular_file(path) && path.extension() == ".in";
-            });
-            std::sort(in_files.begin(), in_files.end());
-            std::vector <std::string> test_names;
-            for (const fs::path &path : in_files) {
-                std::string test_name = path.filename().string();
-                test_names.push_back(std::string(test_name.begin(), test_name.end() - std::size(".in") + 1));
-            }
-            int index = 0;
-            for (const std::string_view test : test_names) {
-                args.emplace_back(test);
-                res = commands[current_state]["t"](args);
-                if (res != 0) {
-                    std::cout << "\033[31m" << "-- Test failed! Stopped running tests. "
-                            << index << " of " << test_names.size()
-                            << " tests passed before failure" << "\033[0m" << '\n';
-                    return 1;
-                }
-                ++index;
-                args.pop_back();
-            }
-            std::cout << "\033[32m" << "-- All " << std::size(in_files) <<
-                " tests successfully passed!" << "\033[0m\n";
+            for (size_t i = 1; i < arg.size(); ++i)
+                args.push_back(arg[i]);
+            args.push_back("--fail-fast");
+            res = commands[current_state]["t"](args);
         }
         return res;
     });
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#define open _open
+#define read _read
+#define close _close
+#define write _write
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif  // _WIN32
+#include "comparator.h"
+#include "compare_kernel.h"
+
+namespace comproenv {
+
+// Same set of characters as std::isspace in "C" locale, that is used by operator>>
+static inline bool is_space(int c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Whole token must be a number in decimal or scientific notation (also inf and nan)
+static bool parse_number(const std::string &token, double &value) {
+    if (token.empty())
+        return false;
+    #if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    const char *begin = token.data(), *end = token.data() + token.size();
+    // Unlike strtod, from_chars does not accept explicit plus sign
+    if (*begin == '+' && ++begin != end && *begin == '-')
+        return false;
+    auto [ptr, error] = std::from_chars(begin, end, value);
+    return error == std::errc() && ptr == end;
+    #else
+    if (std::isspace((unsigned char)token[0]))
+        return false;
+    char *end;
+    errno = 0;
+    value = std::strtod(token.c_str(), &end);
+    return errno == 0 && end == token.c_str() + token.size();
+    #endif  // __cpp_lib_to_chars
+}
+
+static bool numbers_equal(double result, double expected, double epsilon) {
+    if (std::isnan(expected))
+        return std::isnan(result);
+    if (std::isinf(expected))
+        return result == expected;
+    if (!std::isfinite(result))
+        return false;
+    // Small slack keeps answers like 1.000001 for 1 with epsilon 1e-6
+    double bound = epsilon * (1 + 1e-9);
+    double error = std::fabs(result - expected);
+    return error <= bound || error <= bound * std::fabs(expected);
+}
+
+StreamReader::StreamReader(int file_descriptor, size_t buffer_size) :
+    fd(file_descriptor), owns_fd(false), buffer(buffer_size), base(buffer.data()), pos(0), end(0), eof(false),
+    tee_fd(-1), deadline(0), cancel(nullptr), max_bytes(0), bytes_read(0),
+    line(1), column(1), offset(0), timed_out(false), limit_exceeded(false), cancelled(false) {
+
+}
+
+StreamReader::StreamReader(const std::string &path, size_t buffer_size) :
+    fd(-1), owns_fd(true), buffer(buffer_size), base(buffer.data()), pos(0), end(0), eof(false),
+    tee_fd(-1), deadline(0), cancel(nullptr), max_bytes(0), bytes_read(0),
+    line(1), column(1), offset(0), timed_out(false), limit_exceeded(false), cancelled(false) {
+    #ifdef _WIN32
+    fd = open(path.c_str(), _O_RDONLY | _O_BINARY);
+    #else
+    fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    #endif  // _WIN32
+}
+
+StreamReader::StreamReader(const char *data, size_t size) :
+    fd(-1), owns_fd(false), base(data), pos(0), end(size), eof(true),
+    tee_fd(-1), deadline(0), cancel(nullptr), max_bytes(0), bytes_read(size),
+    line(1), column(1), offset(0), timed_out(false), limit_exceeded(false), cancelled(false) {
+
+}
+
+StreamReader::~StreamReader() {
+    if (owns_fd && fd != -1)
+        close(fd);
+}
+
+bool StreamReader::is_open() const {
+    return fd != -1 || buffer.empty();
+}
+
+void StreamReader::set_tee(int file_descriptor) {
+    tee_fd = file_descriptor;
+}
+
+void StreamReader::set_deadline(double moment) {
+    deadline = moment;
+}
+
+void StreamReader::set_cancel(const std::atomic <bool> *flag) {
+    cancel = flag;
+}
+
+void StreamReader::set_max_bytes(size_t bytes) {
+    max_bytes = bytes;
+}
+
+// Cancellation flag is checked at least this often while waiting for data
+static const double cancel_interval = 0.01;
+
+bool StreamReader::refill() {
+    if (eof || fd == -1)
+        return false;
+    pos = end = 0;
+    while (true) {
+        #ifndef _WIN32
+        if (deadline > 0 || cancel) {
+            if (cancel && cancel->load()) {
+                cancelled = eof = true;
+                return false;
+            }
+            double remaining = deadline > 0 ? deadline - Process::current_time() : cancel_interval;
+            if (remaining <= 0) {
+                timed_out = eof = true;
+                return false;
+            }
+            if (cancel)
+                remaining = std::min(remaining, cancel_interval);
+            struct pollfd event = {fd, POLLIN, 0};
+            if (poll(&event, 1, (int)std::ceil(remaining * 1000)) == 0)
+                continue;
+        }
+        #endif  // _WIN32
+        auto count = read(fd, buffer.data(), (unsigned)buffer.size());
+        if (count > 0) {
+            end = (size_t)count;
+            bytes_read += end;
+            if (tee_fd != -1) {
+                for (size_t written = 0; written < end; ) {
+                    auto chunk = write(tee_fd, buffer.data() + written, (unsigned)(end - written));
+                    if (chunk == -1 && errno == EINTR)
+                        continue;
+                    if (chunk <= 0)
+                        break;
+                    written += (size_t)chunk;
+                }
+            }
+            if (max_bytes > 0 && bytes_read > max_bytes)
+                limit_exceeded = eof = true;
+            return true;
+        }
+        if (count == -1 && errno == EINTR)
+            continue;
+        eof = true;
+        return false;
+    }
+}
+
+TokenComparator::Result TokenComparator::compare(StreamReader &result, StreamReader &expected,
+                                                 const CompareOptions &options) {
+    Result verdict;
+    auto skip_spaces = [](StreamReader &reader) {
+        int c;
+        while ((c = reader.peek()) != -1 && is_space(c))
+            reader.advance();
+    };
+    // Reads the rest of the token into report (up to max_token_length characters)
+    auto read_token = [](StreamReader &reader, std::string &token, size_t max_length = max_token_length) {
+        while (token.size() < max_length && reader.peek() != -1) {
+            const char *data = reader.data();
+            size_t size = std::min(reader.available(), max_length - token.size());
+            size_t length = 0;
+            while (length < size && !is_space((unsigned char)data[length]))
+                ++length;
+            // Token does not contain newlines
+            token.append(data, length);
+            reader.skip(length, 0, 0);
+            if (length < size)
+                return;
+        }
+    };
+    std::string result_number, expected_number;
+    // Identical bytes are skipped in blocks up to the last whitespace, after
+    // it both streams are at the same state: between tokens
+    auto skip_common_prefix = [](StreamReader &result, StreamReader &expected) {
+        while (result.peek() != -1 && expected.peek() != -1) {
+            const char *a = result.data(), *b = expected.data();
+            size_t size = std::min(result.available(), expected.available());
+            CompareKernel::Prefix prefix = CompareKernel::common_prefix(a, b, size);
+            size_t length = prefix.length;
+            while (length > 0 && !is_space((unsigned char)a[length - 1]))
+                --length;
+            if (length == 0)
+                return;
+            // Skipped tail does not contain whitespaces, so it has no newlines too
+            result.skip(length, prefix.newlines, prefix.last_newline);
+            expected.skip(length, prefix.newlines, prefix.last_newline);
+            if (length < size)
+                return;
+        }
+    };
+    while (true) {
+        skip_common_prefix(result, expected);
+        skip_spaces(result);
+        skip_spaces(expected);
+        verdict.result_position = {result.line, result.column, result.offset};
+        verdict.expected_position = {expected.line, expected.column, expected.offset};
+        int a = result.peek(), b = expected.peek();
+        if (a == -1 && b == -1)
+            return verdict;
+        size_t length = 0;
+        if (options.epsilon >= 0) {
+            // Tokens are buffered to be parsed as numbers
+            result_number.clear();
+            expected_number.clear();
+            read_token(result, result_number, max_number_length);
+            read_token(expected, expected_number, max_number_length);
+            a = result.peek();
+            b = expected.peek();
+            bool complete = (a == -1 || is_space(a)) && (b == -1 || is_space(b));
+            if (result_number != expected_number) {
+                double result_value, expected_value;
+                if (complete && parse_number(result_number, result_value) &&
+                    parse_number(expected_number, expected_value) &&
+                    numbers_equal(result_value, expected_value, options.epsilon))
+                    continue;
+                verdict.equal = false;
+                verdict.result_token = result_number.substr(0, max_token_length);
+                verdict.expected_token = expected_number.substr(0, max_token_length);
+                return verdict;
+            }
+            if (complete)
+                continue;
+            // Long tokens with equal beginnings are compared exactly below
+            length = std::min(result_number.size(), max_token_length);
+            verdict.result_token = result_number.substr(0, length);
+        }
+        // Compare current tokens byte by byte without storing them
+        while (true) {
+            bool a_end = (a == -1 || is_space(a));
+            bool b_end = (b == -1 || is_space(b));
+            if (a_end && b_end)
+                break;
+            if (a_end || b_end || a != b) {
+                verdict.equal = false;
+                break;
+            }
+            if (length < max_token_length) {
+                verdict.result_token.push_back((char)a);
+                ++length;
+            }
+            result.advance();
+            expected.advance();
+            a = result.peek();
+            b = expected.peek();
+        }
+        if (!verdict.equal) {
+            verdict.expected_token = verdict.result_token;
+            read_token(result, verdict.result_token);
+            read_token(expected, verdict.expected_token);
+            return verdict;
+        }
+        verdict.result_token.clear();
+    }
+}
+
+TokenComparator::Result TokenComparator::compare(const std::string &result_path, const std::string &expected_path,
+                                                 const CompareOptions &options) {
+    // Missing file is compared as empty one, like an unopened std::ifstream
+    StreamReader result(result_path), expected(expected_path);
+    return compare(result, expected, options);
+}
+
+std::string TokenComparator::describe(const Result &result) {
+    std::string description;
+    auto describe_token = [&description](const std::string &token, const Position &position) {
+        if (token.empty())
+            description += "end of file";
+        else
+            description += "\"" + token + "\"";
+        description += " (line " + std::to_string(position.line) + ", column " + std::to_string(position.column) +
+            ", byte " + std::to_string(position.offset) + ")";
+    };
+    description += "result ";
+    describe_token(result.result_token, result.result_position);
+    description += ", expected ";
+    describe_token(result.expected_token, result.expected_position);
+    return description;
+}
+
+TokenComparator::Result TokenComparator::compare_running(Process &process, const OutputCapture &capture,
+                                                         const std::string &expected_path, size_t output_limit,
+                                                         const CompareOptions &options) {
+    StreamReader result(process.get_stdout_pipe()), expected(expected_path);
+    result.set_tee(capture.get_fd());
+    result.set_deadline(process.get_deadline());
+    result.set_cancel(process.get_cancel());
+    result.set_max_bytes(output_limit);
+    Result verdict = compare(result, expected, options);
+    if (result.cancelled)
+        process.kill();
+    else if (result.timed_out)
+        process.kill(ProcessResult::Limit::TIME);
+    else if (result.limit_exceeded)
+        process.kill(ProcessResult::Limit::OUTPUT);
+    else if (!verdict.equal && !verdict.result_token.empty())
+        process.kill();
+    return verdict;
+}
+
+}  // namespace comproenv
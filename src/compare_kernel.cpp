@@ -0,0 +1,182 @@
+#include <cstring>
+#include <iterator>
+#if defined(__x86_64__) || defined(_M_X64)
+#define COMPROENV_X86_SIMD
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define COMPROENV_AVX2
+#include <immintrin.h>
+#endif  // __GNUC__ || __clang__
+#endif  // __x86_64__ || _M_X64
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif  // _MSC_VER
+#include "compare_kernel.h"
+
+namespace comproenv {
+
+static inline unsigned count_trailing_zeros(unsigned mask) {
+    #ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+    #else
+    return (unsigned)__builtin_ctz(mask);
+    #endif  // _MSC_VER
+}
+
+static inline unsigned highest_bit(unsigned mask) {
+    #ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return (unsigned)index;
+    #else
+    return 31u - (unsigned)__builtin_clz(mask);
+    #endif  // _MSC_VER
+}
+
+static inline unsigned count_bits(unsigned mask) {
+    #ifdef _MSC_VER
+    return (unsigned)__popcnt(mask);
+    #else
+    return (unsigned)__builtin_popcount(mask);
+    #endif  // _MSC_VER
+}
+
+// Handles a block of bytes: mismatch and newline masks have bit i set for byte i
+static inline bool process_block(CompareKernel::Prefix &prefix, size_t block_start,
+                                 unsigned mismatch, unsigned newline) {
+    if (mismatch) {
+        unsigned length = count_trailing_zeros(mismatch);
+        newline &= (1u << length) - 1;
+        prefix.length = block_start + length;
+    }
+    if (newline) {
+        prefix.newlines += count_bits(newline);
+        prefix.last_newline = block_start + highest_bit(newline);
+    }
+    return mismatch != 0;
+}
+
+static CompareKernel::Prefix scalar_tail(CompareKernel::Prefix prefix, const char *a, const char *b,
+                                         size_t start, size_t size) {
+    size_t i = start;
+    for (; i < size && a[i] == b[i]; ++i) {
+        if (a[i] == '\n') {
+            ++prefix.newlines;
+            prefix.last_newline = i;
+        }
+    }
+    prefix.length = i;
+    return prefix;
+}
+
+static CompareKernel::Prefix common_prefix_scalar(const char *a, const char *b, size_t size) {
+    CompareKernel::Prefix prefix;
+    // Compare 8 bytes at once while there are no differences
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned long long x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        if (x != y)
+            break;
+        for (size_t j = i; j < i + 8; ++j) {
+            if (a[j] == '\n') {
+                ++prefix.newlines;
+                prefix.last_newline = j;
+            }
+        }
+    }
+    return scalar_tail(prefix, a, b, i, size);
+}
+
+#ifdef COMPROENV_X86_SIMD
+static CompareKernel::Prefix common_prefix_sse2(const char *a, const char *b, size_t size) {
+    CompareKernel::Prefix prefix;
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        unsigned mismatch = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xFFFFu;
+        unsigned newlines = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, newline));
+        if (process_block(prefix, i, mismatch, newlines))
+            return prefix;
+    }
+    return scalar_tail(prefix, a, b, i, size);
+}
+#endif  // COMPROENV_X86_SIMD
+
+#ifdef COMPROENV_AVX2
+__attribute__((target("avx2")))
+static CompareKernel::Prefix common_prefix_avx2(const char *a, const char *b, size_t size) {
+    CompareKernel::Prefix prefix;
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        unsigned mismatch = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+        unsigned newlines = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, newline));
+        if (process_block(prefix, i, mismatch, newlines))
+            return prefix;
+    }
+    return scalar_tail(prefix, a, b, i, size);
+}
+#endif  // COMPROENV_AVX2
+
+struct KernelInfo {
+    const char *name;
+    CompareKernel::Function function;
+    bool (*is_supported)();
+};
+
+static const KernelInfo kernels[] = {
+    #ifdef COMPROENV_AVX2
+    {"avx2", common_prefix_avx2, []() -> bool {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }},
+    #endif  // COMPROENV_AVX2
+    #ifdef COMPROENV_X86_SIMD
+    {"sse2", common_prefix_sse2, []() -> bool { return true; }},
+    #endif  // COMPROENV_X86_SIMD
+    {"scalar", common_prefix_scalar, []() -> bool { return true; }}
+};
+
+static const KernelInfo *best_kernel() {
+    for (const auto &kernel : kernels)
+        if (kernel.is_supported())
+            return &kernel;
+    return &kernels[std::size(kernels) - 1];
+}
+
+static const KernelInfo *current_kernel = best_kernel();
+
+CompareKernel::Function CompareKernel::implementation = best_kernel()->function;
+
+std::string CompareKernel::get_name() {
+    return current_kernel->name;
+}
+
+std::vector <std::string> CompareKernel::get_available() {
+    std::vector <std::string> result;
+    for (const auto &kernel : kernels)
+        if (kernel.is_supported())
+            result.emplace_back(kernel.name);
+    return result;
+}
+
+bool CompareKernel::select(const std::string &name) {
+    for (const auto &kernel : kernels) {
+        if (name == kernel.name && kernel.is_supported()) {
+            current_kernel = &kernel;
+            implementation = kernel.function;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace comproenv
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cmath>
+#include "complexity.h"
+
+namespace comproenv {
+
+double ComplexityFit::predict(double size) const {
+    return overhead + coefficient * function(size);
+}
+
+// Weighted least squares for t = a + c * f with a, c >= 0, weights make errors relative
+static void fit_model(ComplexityFit &model, const std::vector <double> &sizes, const std::vector <double> &times) {
+    double sw = 0, sf = 0, sff = 0, st = 0, sft = 0;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        double w = 1 / std::max(times[i] * times[i], 1e-18);
+        double f = model.function(sizes[i]);
+        sw += w;
+        sf += w * f;
+        sff += w * f * f;
+        st += w * times[i];
+        sft += w * f * times[i];
+    }
+    double determinant = sw * sff - sf * sf;
+    model.overhead = 0;
+    model.coefficient = 0;
+    if (std::abs(determinant) > 1e-12 * sw * sff) {
+        model.overhead = (st * sff - sf * sft) / determinant;
+        model.coefficient = (sw * sft - sf * st) / determinant;
+    }
+    if (model.coefficient <= 0) {
+        model.coefficient = 0;
+        model.overhead = st / sw;
+    } else if (model.overhead < 0) {
+        model.overhead = 0;
+        model.coefficient = sft / sff;
+    }
+    double squares = 0;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        double relative = (model.predict(sizes[i]) - times[i]) / std::max(times[i], 1e-9);
+        squares += relative * relative;
+    }
+    model.error = std::sqrt(squares / (double)sizes.size());
+}
+
+std::vector <ComplexityFit> Complexity::fit(const std::vector <double> &sizes, const std::vector <double> &times) {
+    static const std::vector <std::pair <const char *, double (*)(double)>> classes = {
+        {"O(1)", [](double) { return 0.0; }},
+        {"O(log n)", [](double n) { return std::log2(std::max(n, 2.0)); }},
+        {"O(sqrt n)", [](double n) { return std::sqrt(n); }},
+        {"O(n)", [](double n) { return n; }},
+        {"O(n log n)", [](double n) { return n * std::log2(std::max(n, 2.0)); }},
+        {"O(n sqrt n)", [](double n) { return n * std::sqrt(n); }},
+        {"O(n^2)", [](double n) { return n * n; }},
+        {"O(n^2 log n)", [](double n) { return n * n * std::log2(std::max(n, 2.0)); }},
+        {"O(n^3)", [](double n) { return n * n * n; }}
+    };
+    std::vector <ComplexityFit> fits;
+    if (sizes.empty() || sizes.size() != times.size())
+        return fits;
+    for (auto &[name, function] : classes) {
+        ComplexityFit model;
+        model.name = name;
+        model.function = function;
+        fit_model(model, sizes, times);
+        fits.push_back(model);
+    }
+    // Simpler class wins when errors are equal
+    std::stable_sort(fits.begin(), fits.end(), [](const ComplexityFit &a, const ComplexityFit &b) {
+        return a.error < b.error;
+    });
+    return fits;
+}
+
+}  // namespace comproenv
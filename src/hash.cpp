@@ -0,0 +1,65 @@
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include "hash.h"
+
+namespace comproenv {
+
+static constexpr uint64_t fnv_offset_basis = 14695981039346656037ull;
+static constexpr uint64_t fnv_prime = 1099511628211ull;
+
+Hasher::Hasher() : state(fnv_offset_basis) {
+
+}
+
+Hasher &Hasher::update(const void *data, size_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        state ^= bytes[i];
+        state *= fnv_prime;
+    }
+    return *this;
+}
+
+Hasher &Hasher::update(std::string_view data) {
+    // Length is hashed too, so that concatenations of different strings differ
+    update((uint64_t)data.size());
+    return update(data.data(), data.size());
+}
+
+Hasher &Hasher::update(uint64_t value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; ++i)
+        bytes[i] = (unsigned char)(value >> (8 * i));
+    return update(bytes, sizeof(bytes));
+}
+
+bool Hasher::update_file(const std::string &path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open())
+        return false;
+    std::vector <char> buffer(1 << 16);
+    uint64_t size = 0;
+    while (f) {
+        f.read(buffer.data(), (std::streamsize)buffer.size());
+        update(buffer.data(), (size_t)f.gcount());
+        size += (uint64_t)f.gcount();
+    }
+    if (f.bad())
+        return false;
+    update(size);
+    return true;
+}
+
+uint64_t Hasher::digest() const {
+    return state;
+}
+
+std::string Hasher::hex_digest() const {
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << state;
+    return out.str();
+}
+
+}  // namespace comproenv
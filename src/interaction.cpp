@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif  // _WIN32
+#include "interaction.h"
+
+namespace comproenv {
+
+#ifndef _WIN32
+// Data read from one process which is not written to the other one yet
+struct Channel {
+    Process &source, &target;
+    std::string buffer;
+    size_t written = 0;
+    bool source_open = true;
+    bool target_open = true;
+    Channel(Process &from, Process &to) : source(from), target(to) {}
+    bool done() const {
+        return !source_open && !target_open;
+    }
+};
+
+static void write_all(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t count = write(fd, data, size);
+        if (count == -1 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return;
+        data += count;
+        size -= (size_t)count;
+    }
+}
+#endif  // _WIN32
+
+#ifndef _WIN32
+// Processes are connected directly, so comproenv adds nothing to exchanges
+static InteractionResult run_connected(ProcessOptions (&options)[2]) {
+    InteractionResult result;
+    int to_solution[2], to_interactor[2];
+    if (!Process::create_pipe(to_solution)) {
+        result.error = std::string("Unable to create pipe: ") + std::strerror(errno);
+        return result;
+    }
+    if (!Process::create_pipe(to_interactor)) {
+        result.error = std::string("Unable to create pipe: ") + std::strerror(errno);
+        close(to_solution[0]);
+        close(to_solution[1]);
+        return result;
+    }
+    options[0].stdin_fd = to_solution[0];
+    options[0].stdout_fd = to_interactor[1];
+    options[1].stdin_fd = to_interactor[0];
+    options[1].stdout_fd = to_solution[1];
+    // Interactor is stopped together with the solution when the test is cancelled
+    options[1].cancel = options[0].cancel;
+    Process solution(options[0]), interactor(options[1]);
+    bool interactor_started = interactor.start();
+    bool solution_started = interactor_started && solution.start();
+    // Only the processes keep the pipes open, so each of them sees the end of file when the other one exits
+    for (int fd : {to_solution[0], to_solution[1], to_interactor[0], to_interactor[1]})
+        close(fd);
+    if (!interactor_started) {
+        result.interactor = interactor.wait();
+        result.error = "Interactor: " + result.interactor.error;
+        return result;
+    }
+    if (!solution_started) {
+        interactor.kill();
+        result.interactor = interactor.wait();
+        result.solution = solution.wait();
+        result.error = result.solution.error;
+        return result;
+    }
+    result.solution = solution.wait();
+    if (result.solution.killed || result.solution.exceeded_limit != ProcessResult::Limit::NONE)
+        interactor.kill();
+    result.interactor = interactor.wait();
+    return result;
+}
+#endif  // _WIN32
+
+InteractionResult Interaction::run(const ProcessOptions &solution_options, const ProcessOptions &interactor_options,
+                                   bool relay, const OutputCapture *transcript) {
+    InteractionResult result;
+    #ifdef _WIN32
+    (void)solution_options;
+    (void)interactor_options;
+    (void)relay;
+    (void)transcript;
+    result.error = "Interactive problems are not supported on Windows";
+    return result;
+    #else
+    ProcessOptions options[2] = {solution_options, interactor_options};
+    for (auto &process_options : options) {
+        process_options.stdin_path.clear();
+        process_options.stdin_pipe = false;
+        process_options.stdin_data = nullptr;
+        process_options.stdin_writer = relay;
+        process_options.stdout_capture = nullptr;
+        process_options.stdout_pipe = relay;
+    }
+    if (!relay)
+        return run_connected(options);
+    result.relayed = true;
+    Process solution(options[0]), interactor(options[1]);
+    if (!interactor.start()) {
+        result.interactor = interactor.wait();
+        result.error = "Interactor: " + result.interactor.error;
+        return result;
+    }
+    if (!solution.start()) {
+        interactor.kill();
+        result.interactor = interactor.wait();
+        result.solution = solution.wait();
+        result.error = result.solution.error;
+        return result;
+    }
+    // Processes may close their stdin at any moment, EPIPE is enough to notice that
+    sigset_t signals, old_signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, &old_signals);
+    for (Process *process : {&solution, &interactor})
+        fcntl(process->get_stdin_pipe(), F_SETFL, fcntl(process->get_stdin_pipe(), F_GETFL) | O_NONBLOCK);
+
+    Channel to_solution(interactor, solution), to_interactor(solution, interactor);
+    Channel *channels[2] = {&to_solution, &to_interactor};
+    bool waiting_reply = false;
+    double delivery_time = 0;
+    double deadline = solution.get_deadline();
+    // Interaction is stopped when the test is cancelled, the flag is checked at least this often
+    const std::atomic <bool> *cancel = solution.get_cancel();
+    const double cancel_interval = 0.01;
+    std::vector <char> chunk(1 << 16);
+    while (!to_solution.done() || !to_interactor.done()) {
+        struct pollfd events[4];
+        Channel *event_channels[4];
+        bool event_reads[4];
+        int events_count = 0;
+        for (Channel *channel : channels) {
+            // New data is read only when the previous one is delivered
+            if (channel->written < channel->buffer.size() && channel->target_open) {
+                events[events_count] = {channel->target.get_stdin_pipe(), POLLOUT, 0};
+                event_reads[events_count] = false;
+            } else if (channel->source_open) {
+                events[events_count] = {channel->source.get_stdout_pipe(), POLLIN, 0};
+                event_reads[events_count] = true;
+            } else {
+                continue;
+            }
+            event_channels[events_count++] = channel;
+        }
+        if (cancel && cancel->load()) {
+            solution.kill();
+            interactor.kill();
+            break;
+        }
+        int timeout = cancel ? (int)std::ceil(cancel_interval * 1000) : -1;
+        if (deadline > 0) {
+            double remaining = deadline - Process::current_time();
+            if (remaining <= 0) {
+                solution.kill(ProcessResult::Limit::TIME);
+                interactor.kill();
+                break;
+            }
+            timeout = (int)std::ceil((cancel ? std::min(remaining, cancel_interval) : remaining) * 1000);
+        }
+        int ready = poll(events, (nfds_t)events_count, timeout);
+        if (ready == -1 && errno != EINTR)
+            break;
+        for (int i = 0; i < events_count && ready > 0; ++i) {
+            if (events[i].revents == 0)
+                continue;
+            Channel &channel = *event_channels[i];
+            if (event_reads[i]) {
+                ssize_t count = read(events[i].fd, chunk.data(), chunk.size());
+                if (count == -1 && (errno == EINTR || errno == EAGAIN))
+                    continue;
+                if (count <= 0) {
+                    channel.source_open = false;
+                    // Process on the other side reads end of file
+                    channel.target.close_stdin_pipe();
+                    channel.target_open = false;
+                    continue;
+                }
+                if (&channel == &to_interactor) {
+                    result.solution_bytes += (size_t)count;
+                    if (transcript)
+                        write_all(transcript->get_fd(), chunk.data(), (size_t)count);
+                    if (waiting_reply) {
+                        double latency = Process::current_time() - delivery_time;
+                        ++result.exchanges;
+                        result.total_latency += latency;
+                        result.max_latency = std::max(result.max_latency, latency);
+                        waiting_reply = false;
+                    }
+                } else {
+                    result.interactor_bytes += (size_t)count;
+                }
+                if (channel.target_open) {
+                    channel.buffer.erase(0, channel.written);
+                    channel.written = 0;
+                    channel.buffer.append(chunk.data(), (size_t)count);
+                }
+            } else {
+                ssize_t count = write(events[i].fd, channel.buffer.data() + channel.written,
+                                      channel.buffer.size() - channel.written);
+                if (count == -1 && (errno == EINTR || errno == EAGAIN))
+                    continue;
+                if (count <= 0) {
+                    // Process does not read its input any more, the rest is dropped
+                    channel.target.close_stdin_pipe();
+                    channel.target_open = false;
+                    channel.buffer.clear();
+                    channel.written = 0;
+                    continue;
+                }
+                channel.written += (size_t)count;
+                if (&channel == &to_solution && channel.written == channel.buffer.size() && !waiting_reply) {
+                    waiting_reply = true;
+                    delivery_time = Process::current_time();
+                }
+            }
+        }
+    }
+    result.interactor = interactor.wait();
+    result.solution = solution.wait();
+    // SIGPIPE which was raised by writing to closed pipe must not be delivered after unblocking
+    sigset_t pending;
+    sigpending(&pending);
+    if (sigismember(&pending, SIGPIPE)) {
+        int signal_number;
+        sigwait(&signals, &signal_number);
+    }
+    pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+    return result;
+    #endif  // _WIN32
+}
+
+std::string Interaction::format_stats(const InteractionResult &result) {
+    if (!result.relayed)
+        return "processes are connected directly, exchanges are not counted";
+    std::ostringstream out;
+    out << result.exchanges << " exchanges";
+    if (result.exchanges > 0) {
+        out << std::fixed << std::setprecision(3) <<
+            ", latency: mean " << result.total_latency / (double)result.exchanges * 1000 << " ms" <<
+            ", max " << result.max_latency * 1000 << " ms (including relay through comproenv)";
+    }
+    out << ", solution wrote " << result.solution_bytes << " bytes, interactor wrote " <<
+        result.interactor_bytes << " bytes";
+    return out.str();
+}
+
+}  // namespace comproenv
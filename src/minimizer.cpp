@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <thread>
+#include "minimizer.h"
+#include "test_runner.h"
+
+namespace comproenv {
+
+Minimizer::Minimizer(const Predicate &predicate, unsigned jobs_count) :
+    still_fails(predicate), jobs(jobs_count == 0 ? TestRunner::default_jobs() : jobs_count), evaluations(0) {}
+
+size_t Minimizer::get_evaluations() const {
+    return evaluations;
+}
+
+static std::string join_units(const std::vector <std::string> &units, size_t skip_begin = 0, size_t skip_end = 0) {
+    std::string result;
+    for (size_t i = 0; i < units.size(); ++i)
+        if (i < skip_begin || i >= skip_end)
+            result += units[i];
+    return result;
+}
+
+// Lines with their line breaks
+static std::vector <std::string> split_lines(const std::string &text) {
+    std::vector <std::string> lines;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        end = end == std::string::npos ? text.size() : end + 1;
+        lines.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return lines;
+}
+
+// Tokens with whitespaces that follow them, leading whitespaces are a separate unit
+static std::vector <std::string> split_tokens(const std::string &text) {
+    std::vector <std::string> tokens;
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = begin;
+        while (end < text.size() && !std::isspace((unsigned char)text[end]))
+            ++end;
+        while (end < text.size() && std::isspace((unsigned char)text[end]))
+            ++end;
+        tokens.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return tokens;
+}
+
+// Smaller (by absolute value) integers to try instead of the token, the most reduced ones go first
+static std::vector <std::string> get_smaller_numbers(const std::string &token) {
+    bool negative = !token.empty() && token[0] == '-';
+    size_t digits_begin = negative ? 1 : 0;
+    if (token.size() == digits_begin ||
+        !std::all_of(token.begin() + (long)digits_begin, token.end(), [](char c) { return std::isdigit((unsigned char)c); }))
+        return {};
+    std::vector <std::string> result;
+    try {
+        long long value = std::stoll(token);
+        // Magnitude of LLONG_MIN does not fit into long long
+        auto magnitude = [](long long x) {
+            return x < 0 ? 0ULL - (unsigned long long)x : (unsigned long long)x;
+        };
+        for (long long candidate : {0LL, value / 2, value > 0 ? value - 1 : value + 1})
+            if (magnitude(candidate) < magnitude(value))
+                result.push_back(std::to_string(candidate));
+    } catch (std::out_of_range &) {
+        result = {"0", token.substr(0, token.size() - 1)};
+    }
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::optional <size_t> Minimizer::find_failing(const std::vector <std::string> &candidates) {
+    for (size_t start = 0; start < candidates.size(); start += jobs) {
+        size_t end = std::min<size_t>(candidates.size(), start + jobs);
+        std::vector <char> fails(end - start);
+        std::vector <std::thread> threads;
+        for (size_t i = start + 1; i < end; ++i)
+            threads.emplace_back([&, i]() { fails[i - start] = still_fails(candidates[i]); });
+        fails[0] = still_fails(candidates[start]);
+        for (auto &thread : threads)
+            thread.join();
+        evaluations += end - start;
+        for (size_t i = 0; i < fails.size(); ++i)
+            if (fails[i])
+                return start + i;
+    }
+    return std::nullopt;
+}
+
+bool Minimizer::remove_units(std::vector <std::string> &units, const Progress &progress) {
+    bool reduced = false;
+    size_t chunks = 2;
+    while (!units.empty()) {
+        chunks = std::min(chunks, units.size());
+        std::vector <std::string> candidates;
+        for (size_t i = 0; i < chunks; ++i)
+            candidates.push_back(join_units(units, i * units.size() / chunks, (i + 1) * units.size() / chunks));
+        std::optional <size_t> failing = find_failing(candidates);
+        if (failing.has_value()) {
+            size_t i = failing.value();
+            units.erase(units.begin() + (long)(i * units.size() / chunks),
+                        units.begin() + (long)((i + 1) * units.size() / chunks));
+            reduced = true;
+            progress(candidates[i].size());
+            chunks = std::max<size_t>(chunks - 1, 2);
+        } else if (chunks == units.size()) {
+            break;
+        } else {
+            chunks = std::min(chunks * 2, units.size());
+        }
+    }
+    return reduced;
+}
+
+bool Minimizer::shrink_numbers(std::vector <std::string> &units, const Progress &progress) {
+    bool reduced = false;
+    for (size_t i = 0; i < units.size(); ++i) {
+        while (true) {
+            size_t token_end = 0;
+            while (token_end < units[i].size() && !std::isspace((unsigned char)units[i][token_end]))
+                ++token_end;
+            std::string token = units[i].substr(0, token_end), separator = units[i].substr(token_end);
+            std::vector <std::string> numbers = get_smaller_numbers(token);
+            std::vector <std::string> candidates;
+            std::string original = units[i];
+            for (auto &number : numbers) {
+                units[i] = number + separator;
+                candidates.push_back(join_units(units));
+            }
+            units[i] = original;
+            std::optional <size_t> failing = find_failing(candidates);
+            if (!failing.has_value())
+                break;
+            units[i] = numbers[failing.value()] + separator;
+            reduced = true;
+            progress(candidates[failing.value()].size());
+        }
+    }
+    return reduced;
+}
+
+std::string Minimizer::minimize(const std::string &test, const Progress &progress) {
+    evaluations = 0;
+    std::string current = test;
+    bool reduced = true;
+    while (reduced) {
+        reduced = false;
+        std::vector <std::string> units = split_lines(current);
+        if (remove_units(units, progress)) {
+            current = join_units(units);
+            reduced = true;
+        }
+        units = split_tokens(current);
+        if (remove_units(units, progress)) {
+            current = join_units(units);
+            reduced = true;
+        }
+        units = split_tokens(current);
+        if (shrink_numbers(units, progress)) {
+            current = join_units(units);
+            reduced = true;
+        }
+    }
+    return current;
+}
+
+}  // namespace comproenv
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+#include "perf_counters.h"
+
+namespace comproenv {
+
+PerfCounts::PerfCounts() {
+    values.fill(-1);
+}
+
+bool PerfCounts::available() const {
+    for (long long value : values)
+        if (value >= 0)
+            return true;
+    return false;
+}
+
+PerfCounts &PerfCounts::operator+=(const PerfCounts &other) {
+    for (size_t i = 0; i < values.size(); ++i)
+        if (other.values[i] >= 0)
+            values[i] = std::max(values[i], 0LL) + other.values[i];
+    return *this;
+}
+
+std::string PerfCounts::format() const {
+    static const char *names[EVENTS_COUNT] = {
+        "instructions", "cycles", "branch misses", "cache misses", "page faults", "task clock"
+    };
+    std::ostringstream out;
+    bool need_comma = false;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (values[i] < 0)
+            continue;
+        if (need_comma)
+            out << ", ";
+        out << names[i] << ": ";
+        if (i == TASK_CLOCK)
+            out << std::fixed << std::setprecision(3) << (double)values[i] / 1e6 << " ms";
+        else
+            out << values[i];
+        need_comma = true;
+    }
+    if (values[INSTRUCTIONS] >= 0 && values[CYCLES] > 0)
+        out << ", IPC: " << std::fixed << std::setprecision(2) << (double)values[INSTRUCTIONS] / (double)values[CYCLES];
+    return out.str();
+}
+
+PerfCounters::PerfCounters() {
+    fds.fill(-1);
+}
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+bool PerfCounters::open(int pid, std::string &error) {
+    close();
+    #ifdef __linux__
+    static const std::pair <unsigned, unsigned long long> events[PerfCounts::EVENTS_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK}
+    };
+    bool opened = false;
+    for (size_t i = 0; i < fds.size(); ++i) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[i].first;
+        attr.config = events[i].second;
+        attr.disabled = 1;
+        attr.enable_on_exec = 1;
+        attr.inherit = 1;
+        // Unprivileged users are allowed to count only user space events
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds[i] = (int)syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        if (fds[i] != -1)
+            opened = true;
+        else if (error.empty())
+            error = std::string("Unable to open performance counters: ") + std::strerror(errno);
+    }
+    if (opened)
+        error.clear();
+    return opened;
+    #else
+    (void)pid;
+    error = "Performance counters are supported only on Linux";
+    return false;
+    #endif  // __linux__
+}
+
+PerfCounts PerfCounters::read() const {
+    PerfCounts counts;
+    #ifdef __linux__
+    for (size_t i = 0; i < fds.size(); ++i) {
+        // Value, time enabled and time running, the value is scaled if counters were multiplexed
+        unsigned long long data[3];
+        if (fds[i] == -1 || ::read(fds[i], data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0)
+            continue;
+        if (data[2] < data[1])
+            counts.values[i] = (long long)((double)data[0] * (double)data[1] / (double)data[2]);
+        else
+            counts.values[i] = (long long)data[0];
+    }
+    #endif  // __linux__
+    return counts;
+}
+
+void PerfCounters::close() {
+    for (int &fd : fds) {
+        #ifdef __linux__
+        if (fd != -1)
+            ::close(fd);
+        #endif  // __linux__
+        fd = -1;
+    }
+}
+
+}  // namespace comproenv
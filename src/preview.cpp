@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <vector>
+#include "preview.h"
+
+namespace comproenv {
+
+// Reads up to size bytes from offset, returns number of read bytes
+using ReadFunction = std::function<size_t(size_t offset, char *buffer, size_t size)>;
+
+static const size_t chunk_size = 1 << 16;
+// Bytes of the skipped part in which lines are counted, only a lower bound is shown beyond it
+static const size_t count_budget = 16 * chunk_size;
+
+static void print_preview(std::ostream &out, size_t size, const ReadFunction &read, const PreviewOptions &options) {
+    std::vector <char> chunk(chunk_size);
+    std::string head;
+    size_t offset = 0;
+    int lines_count = 0;
+    int chars_count = 0;
+    bool limited = false;
+    while (offset < size && !limited) {
+        size_t count = read(offset, chunk.data(), std::min(chunk_size, size - offset));
+        if (count == 0)
+            break;
+        for (size_t i = 0; i < count; ++i) {
+            if ((options.max_lines >= 0 && lines_count == options.max_lines) ||
+                (chunk[i] != '\n' && options.max_chars >= 0 && chars_count == options.max_chars) ||
+                (options.max_bytes >= 0 && head.size() == (size_t)options.max_bytes)) {
+                limited = true;
+                break;
+            }
+            head += chunk[i];
+            ++offset;
+            if (chunk[i] == '\n')
+                ++lines_count;
+            else
+                ++chars_count;
+        }
+    }
+    out << head;
+    // Line that is cut by the limits
+    if (!head.empty() && head.back() != '\n')
+        out << (offset < size ? "... (" + std::to_string(size) + " bytes total)" : "") << '\n';
+    if (offset >= size)
+        return;
+    // The tail is taken from the last chunk, lines of the skipped part are counted only
+    // within the budget, so the rest of a large file is not read
+    std::string tail;
+    size_t tail_lines = 0;
+    char last_char = '\n';
+    if (options.tail_lines > 0) {
+        size_t tail_size = options.max_bytes >= 0 ? std::min(chunk_size, (size_t)options.max_bytes) : chunk_size;
+        size_t tail_begin = std::max(offset, size - std::min(size, tail_size));
+        tail.resize(read(tail_begin, chunk.data(), size - tail_begin));
+        std::copy(chunk.begin(), chunk.begin() + (long)tail.size(), tail.begin());
+        if (!tail.empty())
+            last_char = tail.back();
+        // Tail starts after a line break, or at the beginning of the rest if it fits into the chunk,
+        // lines that do not fit are not shown
+        size_t begin = std::string::npos;
+        size_t position = tail.size() - (!tail.empty() && tail.back() == '\n' ? 1 : 0);
+        while (tail_lines < (size_t)options.tail_lines) {
+            size_t line_break = position == 0 ? std::string::npos : tail.rfind('\n', position - 1);
+            if (line_break == std::string::npos) {
+                if (tail_begin == offset) {
+                    begin = 0;
+                    ++tail_lines;
+                }
+                break;
+            }
+            begin = line_break + 1;
+            position = line_break;
+            ++tail_lines;
+        }
+        tail = begin == std::string::npos ? std::string() : tail.substr(begin);
+    } else if (read(size - 1, chunk.data(), 1) == 1) {
+        last_char = chunk[0];
+    }
+    size_t skipped_end = size - tail.size();
+    size_t scan_end = std::min(skipped_end, offset + count_budget);
+    size_t skipped_lines = 0;
+    for (size_t position = offset; position < scan_end;) {
+        size_t count = read(position, chunk.data(), std::min(chunk_size, scan_end - position));
+        if (count == 0)
+            break;
+        skipped_lines += (size_t)std::count(chunk.begin(), chunk.begin() + (long)count, '\n');
+        position += count;
+    }
+    // Last line without a line break is skipped only if there is no tail
+    bool exact = scan_end == skipped_end;
+    if (exact && tail.empty() && last_char != '\n')
+        ++skipped_lines;
+    size_t total_lines = (size_t)std::count(head.begin(), head.end(), '\n') + skipped_lines + tail_lines;
+    const char *bound = exact ? "" : "at least ";
+    out << "... (skipped " << bound << skipped_lines << " lines, " << skipped_end - offset <<
+        " bytes; total " << bound << total_lines << " lines, " << size << " bytes)\n";
+    out << tail;
+    if (!tail.empty() && tail.back() != '\n')
+        out << '\n';
+}
+
+void Preview::print_file(std::ostream &out, const std::string &path, const PreviewOptions &options) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open())
+        return;
+    f.seekg(0, std::ios::end);
+    std::streamoff size = f.tellg();
+    if (size <= 0)
+        return;
+    print_preview(out, (size_t)size, [&f](size_t offset, char *buffer, size_t count) -> size_t {
+        f.clear();
+        f.seekg((std::streamoff)offset);
+        f.read(buffer, (std::streamsize)count);
+        return (size_t)f.gcount();
+    }, options);
+}
+
+void Preview::print_text(std::ostream &out, std::string_view text, const PreviewOptions &options) {
+    print_preview(out, text.size(), [text](size_t offset, char *buffer, size_t count) -> size_t {
+        count = std::min(count, text.size() - std::min(offset, text.size()));
+        std::copy(text.begin() + (long)offset, text.begin() + (long)(offset + count), buffer);
+        return count;
+    }, options);
+}
+
+// Lines of the window around the spot
+struct WindowLine {
+    size_t number;
+    std::string text;
+};
+
+// Reads context lines before and after the line of the spot, lines which do not fit into
+// the chunks around the spot are cut
+static std::vector <WindowLine> read_window(const FileSpot &spot, int context_lines) {
+    std::vector <WindowLine> lines;
+    std::ifstream f(spot.path, std::ios::binary);
+    if (!f.is_open())
+        return lines;
+    size_t begin = spot.offset - std::min(spot.offset, chunk_size);
+    std::string window(chunk_size + (spot.offset - begin), '\0');
+    f.seekg((std::streamoff)begin);
+    f.read(window.data(), (std::streamsize)window.size());
+    window.resize((size_t)f.gcount());
+    size_t spot_index = std::min(spot.offset - begin, window.size());
+    // Beginning of the spot line and context lines before it
+    size_t line_break = spot_index == 0 ? std::string::npos : window.rfind('\n', spot_index - 1);
+    size_t first = line_break == std::string::npos ? 0 : line_break + 1;
+    size_t first_number = spot.line;
+    for (int i = 0; i < context_lines && first > 0 && first_number > 1; ++i) {
+        line_break = first >= 2 ? window.rfind('\n', first - 2) : std::string::npos;
+        first = line_break == std::string::npos ? 0 : line_break + 1;
+        --first_number;
+    }
+    size_t number = first_number;
+    size_t position = first;
+    while (position < window.size() && number <= spot.line + (size_t)context_lines) {
+        size_t line_end = window.find('\n', position);
+        if (line_end == std::string::npos)
+            line_end = window.size();
+        lines.push_back({number++, window.substr(position, line_end - position)});
+        position = line_end + 1;
+    }
+    if (lines.empty() || lines.back().number < spot.line)
+        lines.push_back({spot.line, ""});
+    return lines;
+}
+
+void Preview::print_diff(std::ostream &out, const FileSpot &result, const FileSpot &expected, int context_lines) {
+    static const size_t max_width = 100;
+    std::vector <WindowLine> windows[2] = {read_window(result, context_lines), read_window(expected, context_lines)};
+    const FileSpot *spots[2] = {&result, &expected};
+    const char *titles[2] = {"Result", "Expected"};
+    // Lines are paired by their distance from the spots
+    auto counterpart = [&](size_t window, const WindowLine &line) -> const std::string * {
+        const FileSpot &spot = *spots[window], &other_spot = *spots[1 - window];
+        for (const WindowLine &other : windows[1 - window])
+            if (other.number + spot.line == line.number + other_spot.line)
+                return &other.text;
+        return nullptr;
+    };
+    for (size_t window = 0; window < 2; ++window) {
+        const FileSpot &spot = *spots[window];
+        out << "-- " << titles[window] << " around line " << spot.line << ", column " << spot.column <<
+            " (byte " << spot.offset << "):\n";
+        for (const WindowLine &line : windows[window]) {
+            const std::string *other = counterpart(window, line);
+            char marker = line.number == spot.line ? '>' : (other && *other == line.text ? ' ' : '!');
+            // Long lines are shown around the column of the spot
+            size_t shift = 0;
+            if (line.number == spot.line && spot.column > max_width / 2 && line.text.size() > max_width)
+                shift = std::min(spot.column - max_width / 2, line.text.size() - max_width / 2);
+            std::string text = line.text.substr(std::min(shift, line.text.size()), max_width);
+            out << marker << std::setw(8) << line.number << " | " << (shift > 0 ? "..." : "") << text <<
+                (shift + max_width < line.text.size() ? "..." : "") << '\n';
+            if (line.number == spot.line && spot.column > shift)
+                out << std::string(8 + 4 + (shift > 0 ? 3 : 0), ' ') << std::string(spot.column - shift - 1, ' ') << "^\n";
+        }
+    }
+}
+
+}  // namespace comproenv
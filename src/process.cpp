@@ -0,0 +1,773 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <atomic>
+#include "fs.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sys/uio.h>
+#endif  // __linux__
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+extern char **environ;
+#endif  // _WIN32
+#include "process.h"
+#include "utils.h"
+
+namespace comproenv {
+
+#ifndef _WIN32
+// Processes that are not waited for yet, so that they can be killed from signal handler
+static const size_t max_running_processes = 1024;
+static std::atomic <pid_t> running_processes[max_running_processes];
+#endif  // _WIN32
+static std::atomic <bool> interrupted(false);
+
+void Process::interrupt() {
+    interrupted = true;
+    #ifndef _WIN32
+    for (auto &slot : running_processes) {
+        pid_t running = slot.load();
+        if (running > 0)
+            ::kill(running, SIGKILL);
+    }
+    #endif  // _WIN32
+}
+
+void Process::clear_interrupt() {
+    interrupted = false;
+}
+
+bool Process::is_interrupted() {
+    return interrupted;
+}
+
+double Process::current_time() {
+    return std::chrono::duration_cast<std::chrono::duration<double>>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifndef _WIN32
+#if defined(__linux__) || defined(__FreeBSD__)
+#define ATOMIC_CLOEXEC
+#endif  // __linux__ || __FreeBSD__
+
+// Without pipe2 descriptors are marked close-on-exec by a separate call, so a fork of
+// another thread in between would leak them into its child. Creation and fork hold this lock
+static std::unique_lock <std::mutex> lock_descriptors() {
+    #ifdef ATOMIC_CLOEXEC
+    return std::unique_lock <std::mutex>();
+    #else
+    static std::mutex descriptors_mutex;
+    return std::unique_lock <std::mutex>(descriptors_mutex);
+    #endif  // ATOMIC_CLOEXEC
+}
+
+static bool open_pipe(int fds[2]) {
+    #ifdef ATOMIC_CLOEXEC
+    return pipe2(fds, O_CLOEXEC) == 0;
+    #else
+    auto lock = lock_descriptors();
+    if (pipe(fds) != 0)
+        return false;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+    #endif  // ATOMIC_CLOEXEC
+}
+
+struct ChildSetup {
+    int stdin_fd, stdout_fd, stderr_fd, error_fd;
+    // Parent writes a byte into this pipe when it is ready for exec (e.g. counters are opened)
+    int sync_fd;
+    // Captured output is a regular file, so writes beyond the limit raise SIGXFSZ
+    bool limit_output;
+    ProcessLimits limits;
+    const char *executable;
+    char *const *argv;
+};
+
+// Only async-signal-safe calls are allowed here
+[[noreturn]] static void exec_child(const ChildSetup &setup) {
+    if (setup.stdin_fd != -1 && dup2(setup.stdin_fd, STDIN_FILENO) == -1)
+        _exit(127);
+    if (setup.stdout_fd != -1 && dup2(setup.stdout_fd, STDOUT_FILENO) == -1)
+        _exit(127);
+    if (setup.stderr_fd != -1 && dup2(setup.stderr_fd, STDERR_FILENO) == -1)
+        _exit(127);
+    signal(SIGPIPE, SIG_DFL);
+    const ProcessLimits &limits = setup.limits;
+    if (limits.time_limit > 0) {
+        // Soft limit sends SIGXCPU, hard one kills process if SIGXCPU is handled,
+        // fractional limits are enforced by the wall time watchdog and check of CPU time
+        rlim_t seconds = (rlim_t)std::ceil(limits.time_limit);
+        struct rlimit limit = {seconds, seconds + 1};
+        setrlimit(RLIMIT_CPU, &limit);
+    }
+    if (limits.memory_limit > 0) {
+        struct rlimit limit = {(rlim_t)limits.memory_limit, (rlim_t)limits.memory_limit};
+        setrlimit(RLIMIT_AS, &limit);
+    }
+    if (setup.limit_output) {
+        struct rlimit limit = {(rlim_t)limits.output_limit + 1, (rlim_t)limits.output_limit + 1};
+        setrlimit(RLIMIT_FSIZE, &limit);
+    }
+    if (setup.sync_fd != -1) {
+        char ready;
+        while (read(setup.sync_fd, &ready, 1) == -1 && errno == EINTR) {}
+    }
+    execve(setup.executable, setup.argv, environ);
+    int error = errno;
+    ssize_t written = write(setup.error_fd, &error, sizeof(error));
+    (void)written;
+    _exit(127);
+}
+
+// Path lookup is done before fork, because execvp is not async-signal-safe
+static std::string find_executable(const std::string &name) {
+    if (name.find('/') != std::string::npos)
+        return name;
+    const char *env_path = getenv("PATH");
+    std::vector <std::string> directories;
+    split(directories, env_path ? env_path : "/usr/bin:/bin", ':');
+    for (auto &directory : directories) {
+        std::string candidate = directory + "/" + name;
+        struct stat info;
+        if (stat(candidate.c_str(), &info) == 0 && S_ISREG(info.st_mode) &&
+            access(candidate.c_str(), X_OK) == 0)
+            return candidate;
+    }
+    return name;
+}
+#endif  // _WIN32
+
+bool Process::create_pipe(int fds[2]) {
+    #ifndef _WIN32
+    return open_pipe(fds);
+    #else
+    (void)fds;
+    return false;
+    #endif  // _WIN32
+}
+
+OutputCapture::OutputCapture() : fd(-1), temporary_file(false) {
+    #if defined(__linux__) && defined(MFD_CLOEXEC)
+    fd = memfd_create("comproenv_output", MFD_CLOEXEC);
+    if (fd != -1) {
+        // Path of comproenv itself, so that other processes (e.g. checker) can read it too
+        path = "/proc/" + std::to_string(getpid()) + "/fd/" + std::to_string(fd);
+        return;
+    }
+    #endif  // __linux__ && MFD_CLOEXEC
+    temporary_file = true;
+    #ifdef _WIN32
+    static std::atomic <unsigned> counter(0);
+    path = (fs::temp_directory_path() / ("comproenv_" + std::to_string(GetCurrentProcessId()) + "_" +
+        std::to_string(counter++) + ".txt")).string();
+    #else
+    std::string file_template = (fs::temp_directory_path() / "comproenv_XXXXXX").string();
+    std::vector <char> buffer(file_template.begin(), file_template.end());
+    buffer.push_back('\0');
+    {
+        auto lock = lock_descriptors();
+        fd = mkstemp(buffer.data());
+        if (fd != -1)
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    if (fd == -1)
+        throw std::runtime_error("Unable to create temporary file for output");
+    path = buffer.data();
+    #endif  // _WIN32
+}
+
+OutputCapture::~OutputCapture() {
+    #ifndef _WIN32
+    if (fd != -1)
+        close(fd);
+    #endif  // _WIN32
+    if (temporary_file)
+        std::remove(path.c_str());
+}
+
+int OutputCapture::get_fd() const {
+    return fd;
+}
+
+const std::string &OutputCapture::get_path() const {
+    return path;
+}
+
+Process::Process(const ProcessOptions &process_options) : options(process_options),
+    #ifndef _WIN32
+    pid(-1), stdin_pipe(-1), stdout_pipe(-1), stop_feeding(false), fed_bytes(0), feeding_time(0),
+    #endif  // _WIN32
+    start_time(0), kill_requested(false), kill_reason(ProcessResult::Limit::NONE) {
+
+}
+
+Process::~Process() {
+    #ifndef _WIN32
+    if (pid != -1) {
+        kill();
+        wait();
+    }
+    close_stdin_pipe();
+    if (stdout_pipe != -1)
+        close(stdout_pipe);
+    #endif  // _WIN32
+}
+
+#ifndef _WIN32
+// Waits until pipe can be written, returns false if feeding should be stopped
+static bool wait_writable(int pipe_fd, const std::atomic <bool> &stop) {
+    while (!stop) {
+        struct pollfd event = {pipe_fd, POLLOUT, 0};
+        int ret = poll(&event, 1, 100);
+        if (ret > 0)
+            return (event.revents & (POLLERR | POLLHUP)) == 0;
+        if (ret == -1 && errno != EINTR)
+            return false;
+    }
+    return false;
+}
+
+// Feeds memory to nonblocking pipe, on Linux pages are moved into the pipe by
+// vmsplice without copying. Returns number of bytes which were fed.
+static size_t feed_buffer(int pipe_fd, const char *data, size_t size, const std::atomic <bool> &stop) {
+    size_t done = 0;
+    #ifdef __linux__
+    bool use_vmsplice = true;
+    #endif  // __linux__
+    while (done < size) {
+        ssize_t count;
+        #ifdef __linux__
+        if (use_vmsplice) {
+            struct iovec chunk = {const_cast<char *>(data + done), size - done};
+            count = vmsplice(pipe_fd, &chunk, 1, SPLICE_F_NONBLOCK);
+            if (count == -1 && (errno == EINVAL || errno == ENOSYS)) {
+                use_vmsplice = false;
+                continue;
+            }
+        } else {
+            count = write(pipe_fd, data + done, size - done);
+        }
+        #else
+        count = write(pipe_fd, data + done, size - done);
+        #endif  // __linux__
+        if (count > 0) {
+            done += (size_t)count;
+        } else if (count == -1 && errno == EINTR) {
+            continue;
+        } else if (count == -1 && errno == EAGAIN) {
+            if (!wait_writable(pipe_fd, stop))
+                break;
+        } else {
+            break;
+        }
+    }
+    return done;
+}
+
+// Feeds file or memory buffer to stdin of the process, runs in a separate thread
+void Process::feed_input(int pipe_fd, int file_fd) {
+    // Process may exit without reading its input, EPIPE is enough to notice that
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    double feeding_start = current_time();
+    size_t done = 0;
+    if (file_fd == -1) {
+        done = feed_buffer(pipe_fd, options.stdin_data->data(), options.stdin_data->size(), stop_feeding);
+    } else {
+        bool fed = false;
+        #ifdef __linux__
+        // File pages go to the pipe without passing through user space
+        while (true) {
+            ssize_t count = splice(file_fd, nullptr, pipe_fd, nullptr, 1 << 20,
+                                   SPLICE_F_MOVE | SPLICE_F_MORE | SPLICE_F_NONBLOCK);
+            if (count > 0) {
+                done += (size_t)count;
+            } else if (count == 0) {
+                fed = true;
+                break;
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN) {
+                if (!wait_writable(pipe_fd, stop_feeding)) {
+                    fed = true;
+                    break;
+                }
+            } else {
+                // Source does not support splice, the rest is fed from memory
+                fed = done != 0;
+                break;
+            }
+        }
+        #endif  // __linux__
+        struct stat info;
+        if (!fed && fstat(file_fd, &info) == 0 && info.st_size > 0) {
+            void *mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file_fd, 0);
+            if (mapping != MAP_FAILED) {
+                done = feed_buffer(pipe_fd, static_cast<const char *>(mapping), (size_t)info.st_size, stop_feeding);
+                munmap(mapping, (size_t)info.st_size);
+            }
+        }
+        close(file_fd);
+    }
+    close(pipe_fd);
+    fed_bytes = done;
+    feeding_time = current_time() - feeding_start;
+}
+#endif  // _WIN32
+
+bool Process::split_command(std::vector <std::string> &out, const std::string_view command) {
+    out.clear();
+    std::string current;
+    bool has_token = false;
+    char quote = 0;
+    for (size_t i = 0; i < command.size(); ++i) {
+        char c = command[i];
+        if (quote == '\'') {
+            if (c == '\'')
+                quote = 0;
+            else
+                current.push_back(c);
+        } else if (quote == '"') {
+            if (c == '"') {
+                quote = 0;
+            } else if (c == '$' || c == '`') {
+                return false;
+            } else if (c == '\\' && i + 1 < command.size() &&
+                       std::strchr("$`\"\\", command[i + 1])) {
+                current.push_back(command[++i]);
+            } else {
+                current.push_back(c);
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            has_token = true;
+        } else if (c == '\\' && i + 1 < command.size()) {
+            current.push_back(command[++i]);
+            has_token = true;
+        } else if (c == ' ' || c == '\t') {
+            if (has_token)
+                out.push_back(current);
+            current.clear();
+            has_token = false;
+        } else if (std::strchr("|&;<>()$`*?[]{}~#\n", c)) {
+            return false;
+        } else if (c == '=' && out.empty()) {
+            // Environment variable assignment
+            return false;
+        } else {
+            current.push_back(c);
+            has_token = true;
+        }
+    }
+    if (quote != 0)
+        return false;
+    if (has_token)
+        out.push_back(current);
+    return !out.empty();
+}
+
+bool Process::start() {
+    result = ProcessResult();
+    kill_requested = false;
+    kill_reason = ProcessResult::Limit::NONE;
+    if (interrupted) {
+        result.error = "Interrupted";
+        return false;
+    }
+    #ifdef _WIN32
+    start_time = current_time();
+    result.launched = true;
+    return true;
+    #else
+    std::vector <std::string> args;
+    if (!split_command(args, options.command))
+        args = {"/bin/sh", "-c", options.command};
+    std::string executable = find_executable(args[0]);
+    std::vector <char *> argv;
+    for (auto &arg : args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+    int stdin_fd = -1;
+    if (!options.stdin_path.empty()) {
+        stdin_fd = open(options.stdin_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (stdin_fd == -1) {
+            result.error = "Unable to open " + options.stdin_path + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+    // Input that is fed through a pipe: (file_fd, pipe[1]) are passed to the feeder thread
+    // or pipe[1] is written by the owner of the process
+    int input_pipe[2] = {-1, -1};
+    int input_file_fd = -1;
+    if (options.stdin_writer && stdin_fd == -1) {
+        if (!open_pipe(input_pipe)) {
+            result.error = std::string("Unable to create pipe: ") + std::strerror(errno);
+            return false;
+        }
+        stdin_fd = input_pipe[0];
+    } else if ((options.stdin_pipe && stdin_fd != -1) || (options.stdin_path.empty() && options.stdin_data)) {
+        if (!open_pipe(input_pipe)) {
+            result.error = std::string("Unable to create pipe: ") + std::strerror(errno);
+            if (stdin_fd != -1)
+                close(stdin_fd);
+            return false;
+        }
+        fcntl(input_pipe[1], F_SETFL, fcntl(input_pipe[1], F_GETFL) | O_NONBLOCK);
+        #if defined(__linux__) && defined(F_SETPIPE_SZ)
+        fcntl(input_pipe[1], F_SETPIPE_SZ, 1 << 20);
+        #endif  // __linux__ && F_SETPIPE_SZ
+        input_file_fd = stdin_fd;
+        stdin_fd = input_pipe[0];
+    }
+    // Closes descriptors of the parent if the process can not be started
+    auto close_input = [&]() {
+        if (stdin_fd != -1)
+            close(stdin_fd);
+        if (input_pipe[1] != -1)
+            close(input_pipe[1]);
+        if (input_file_fd != -1)
+            close(input_file_fd);
+    };
+    int stdout_fd = options.stdout_capture ? options.stdout_capture->get_fd() : -1;
+    int output_pipe[2] = {-1, -1};
+    if (options.stdout_pipe) {
+        if (!open_pipe(output_pipe)) {
+            result.error = std::string("Unable to create pipe: ") + std::strerror(errno);
+            close_input();
+            return false;
+        }
+        stdout_fd = output_pipe[1];
+    }
+    // Child reports exec failure through this pipe, it is closed on successful exec
+    int error_pipe[2];
+    if (!open_pipe(error_pipe)) {
+        result.error = std::string("Unable to create pipe: ") + std::strerror(errno);
+        close_input();
+        if (output_pipe[0] != -1) {
+            close(output_pipe[0]);
+            close(output_pipe[1]);
+        }
+        return false;
+    }
+    // Counters have to be opened before exec, so the child waits for them
+    int sync_pipe[2] = {-1, -1};
+    if (options.perf_counters && !open_pipe(sync_pipe))
+        sync_pipe[0] = sync_pipe[1] = -1;
+    int stderr_fd = options.stderr_capture ? options.stderr_capture->get_fd() : -1;
+    ChildSetup setup = {stdin_fd != -1 ? stdin_fd : options.stdin_fd,
+                        stdout_fd != -1 ? stdout_fd : options.stdout_fd, stderr_fd, error_pipe[1], sync_pipe[0],
+                        options.limits.output_limit > 0 && stdout_fd != -1 && !options.stdout_pipe,
+                        options.limits, executable.c_str(), argv.data()};
+    start_time = current_time();
+    int fork_error;
+    {
+        auto lock = lock_descriptors();
+        pid = fork();
+        if (pid == 0)
+            exec_child(setup);
+        fork_error = errno;
+    }
+    if (pid != -1) {
+        for (auto &slot : running_processes) {
+            pid_t empty = 0;
+            if (slot.compare_exchange_strong(empty, pid))
+                break;
+        }
+        // Interruption that happened before registration does not see the process
+        if (interrupted)
+            ::kill(pid, SIGKILL);
+    }
+    close(error_pipe[1]);
+    if (sync_pipe[0] != -1) {
+        close(sync_pipe[0]);
+        // Events are not counted if counters are not available, it is reported by empty counts
+        std::string error;
+        if (pid != -1)
+            perf_counters.open(pid, error);
+        ssize_t written = write(sync_pipe[1], "", 1);
+        (void)written;
+        close(sync_pipe[1]);
+    }
+    if (stdin_fd != -1)
+        close(stdin_fd);
+    if (output_pipe[1] != -1)
+        close(output_pipe[1]);
+    stdout_pipe = output_pipe[0];
+    if (pid == -1) {
+        close(error_pipe[0]);
+        if (input_pipe[1] != -1)
+            close(input_pipe[1]);
+        if (input_file_fd != -1)
+            close(input_file_fd);
+        result.error = std::string("Unable to create process: ") + std::strerror(fork_error);
+        return false;
+    }
+    if (input_pipe[1] != -1 && options.stdin_writer) {
+        stdin_pipe = input_pipe[1];
+    } else if (input_pipe[1] != -1) {
+        stop_feeding = false;
+        input_feeder = std::thread(&Process::feed_input, this, input_pipe[1], input_file_fd);
+    }
+    int exec_error = 0;
+    ssize_t bytes_read;
+    do {
+        bytes_read = read(error_pipe[0], &exec_error, sizeof(exec_error));
+    } while (bytes_read == -1 && errno == EINTR);
+    close(error_pipe[0]);
+    if (bytes_read == sizeof(exec_error)) {
+        wait();
+        result.launched = false;
+        result.error = "Unable to launch " + args[0] + ": " + std::strerror(exec_error);
+        return false;
+    }
+    result.launched = true;
+    return true;
+    #endif  // _WIN32
+}
+
+ProcessResult Process::wait() {
+    #ifdef _WIN32
+    std::string command = options.command;
+    // Data for stdin is stored into temporary file, because there is no feeder thread
+    std::optional <OutputCapture> input_file;
+    if (!options.stdin_path.empty()) {
+        command += " < \"" + options.stdin_path + "\"";
+    } else if (options.stdin_data) {
+        input_file.emplace();
+        std::ofstream f(input_file->get_path(), std::ios::binary);
+        f.write(options.stdin_data->data(), (std::streamsize)options.stdin_data->size());
+        f.close();
+        command += " < \"" + input_file->get_path() + "\"";
+    }
+    if (options.stdout_capture)
+        command += " > \"" + options.stdout_capture->get_path() + "\"";
+    if (options.stderr_capture)
+        command += " 2> \"" + options.stderr_capture->get_path() + "\"";
+    result.exit_code = system(command.c_str());
+    result.wall_time = current_time() - start_time;
+    #else
+    if (pid == -1)
+        return result;
+    int status = 0;
+    struct rusage usage = {};
+    bool timed_out = false;
+    if (options.limits.time_limit > 0 || options.cancel) {
+        double deadline = options.limits.time_limit > 0 ? get_deadline() : std::numeric_limits<double>::infinity();
+        // Cancellation flag is checked at least this often
+        const double cancel_interval = 0.01;
+        int pidfd = -1;
+        #if defined(__linux__) && defined(SYS_pidfd_open)
+        pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+        #endif  // __linux__ && SYS_pidfd_open
+        double sleep_time = 0.0001;
+        while (true) {
+            siginfo_t info = {};
+            int ret = waitid(P_PID, (id_t)pid, &info, WEXITED | WNOHANG | WNOWAIT);
+            if ((ret == 0 && info.si_pid == pid) || (ret == -1 && errno != EINTR))
+                break;
+            double remaining = deadline - current_time();
+            bool cancelled = options.cancel && options.cancel->load();
+            if (remaining <= 0 || cancelled) {
+                ::kill(pid, SIGKILL);
+                timed_out = !cancelled;
+                kill_requested = kill_requested || cancelled;
+                break;
+            }
+            if (options.cancel)
+                remaining = std::min(remaining, cancel_interval);
+            if (pidfd != -1) {
+                // pidfd becomes readable when the process exits
+                struct pollfd event = {pidfd, POLLIN, 0};
+                poll(&event, 1, (int)std::ceil(remaining * 1000));
+            } else {
+                sleep_time = std::min({sleep_time * 2, 0.01, remaining});
+                std::this_thread::sleep_for(std::chrono::duration<double>(sleep_time));
+            }
+        }
+        if (pidfd != -1)
+            close(pidfd);
+    } else {
+        siginfo_t info;
+        while (waitid(P_PID, (id_t)pid, &info, WEXITED | WNOWAIT) == -1 && errno == EINTR) {}
+    }
+    // Process is reaped only after it is unregistered, so that its pid can not be reused
+    // by another process while interrupt may still kill it
+    for (auto &slot : running_processes) {
+        pid_t running = pid;
+        if (slot.compare_exchange_strong(running, 0))
+            break;
+    }
+    while (wait4(pid, &status, 0, &usage) == -1 && errno == EINTR) {}
+    result.wall_time = current_time() - start_time;
+    pid = -1;
+    if (options.perf_counters) {
+        result.perf_counts = perf_counters.read();
+        perf_counters.close();
+    }
+    if (input_feeder.joinable()) {
+        stop_feeding = true;
+        input_feeder.join();
+        result.input_bytes = fed_bytes;
+        result.input_time = feeding_time;
+    }
+    if (WIFEXITED(status)) {
+        result.exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        result.term_signal = WTERMSIG(status);
+        result.exit_code = 128 + result.term_signal;
+    }
+    result.user_time = (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec / 1e6;
+    result.system_time = (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec / 1e6;
+    result.cpu_time = result.user_time + result.system_time;
+    result.voluntary_context_switches = usage.ru_nvcsw;
+    result.involuntary_context_switches = usage.ru_nivcsw;
+    #ifdef __APPLE__
+    result.peak_memory = (size_t)usage.ru_maxrss;
+    #else
+    result.peak_memory = (size_t)usage.ru_maxrss * 1024;
+    #endif  // __APPLE__
+    close_stdin_pipe();
+    if (stdout_pipe != -1) {
+        close(stdout_pipe);
+        stdout_pipe = -1;
+    }
+    result.killed = kill_requested;
+    if (timed_out)
+        result.exceeded_limit = ProcessResult::Limit::TIME;
+    else if (kill_requested)
+        result.exceeded_limit = kill_reason;
+    check_limits();
+    #endif  // _WIN32
+    return result;
+}
+
+void Process::check_limits() {
+    #ifndef _WIN32
+    const ProcessLimits &limits = options.limits;
+    if (result.exceeded_limit != ProcessResult::Limit::NONE)
+        return;
+    bool failed = result.exit_code != 0 && !result.killed;
+    if (limits.time_limit > 0 && (result.term_signal == SIGXCPU || result.cpu_time > limits.time_limit)) {
+        result.exceeded_limit = ProcessResult::Limit::TIME;
+    } else if (limits.output_limit > 0 && options.stdout_capture) {
+        struct stat info;
+        if (result.term_signal == SIGXFSZ ||
+            (fstat(options.stdout_capture->get_fd(), &info) == 0 && (size_t)info.st_size > limits.output_limit))
+            result.exceeded_limit = ProcessResult::Limit::OUTPUT;
+    }
+    // Allocation that does not fit into address space limit is not seen in peak memory, it usually
+    // happens when a big part of it is already used (e.g. reallocation of std::vector). It is treated
+    // as exceeded limit only if the process aborted (uncaught std::bad_alloc), other failures are errors.
+    // Peak memory above the limit is only a fallback for systems that do not enforce RLIMIT_AS (macOS)
+    if (result.exceeded_limit == ProcessResult::Limit::NONE && limits.memory_limit > 0) {
+        if (result.peak_memory > limits.memory_limit ||
+            (failed && result.term_signal == SIGABRT && result.peak_memory * 2 >= limits.memory_limit))
+            result.exceeded_limit = ProcessResult::Limit::MEMORY;
+        else if (failed && result.peak_memory * 2 >= limits.memory_limit)
+            result.possibly_out_of_memory = true;
+    }
+    #endif  // _WIN32
+}
+
+void Process::kill(ProcessResult::Limit reason) {
+    #ifndef _WIN32
+    if (pid != -1) {
+        kill_requested = true;
+        kill_reason = reason;
+        ::kill(pid, SIGKILL);
+    }
+    #else
+    (void)reason;
+    #endif  // _WIN32
+}
+
+int Process::get_stdin_pipe() const {
+    #ifndef _WIN32
+    return stdin_pipe;
+    #else
+    return -1;
+    #endif  // _WIN32
+}
+
+void Process::close_stdin_pipe() {
+    #ifndef _WIN32
+    if (stdin_pipe != -1) {
+        close(stdin_pipe);
+        stdin_pipe = -1;
+    }
+    #endif  // _WIN32
+}
+
+int Process::get_stdout_pipe() const {
+    #ifndef _WIN32
+    return stdout_pipe;
+    #else
+    return -1;
+    #endif  // _WIN32
+}
+
+const std::atomic <bool> *Process::get_cancel() const {
+    return options.cancel;
+}
+
+double Process::get_deadline() const {
+    if (options.limits.time_limit <= 0)
+        return 0;
+    return start_time + 2 * options.limits.time_limit + 1;
+}
+
+std::string Process::format_usage(const ProcessResult &result) {
+    std::ostringstream out;
+    out << result.wall_time;
+    #ifndef _WIN32
+    out << " (user " << result.user_time << ", system " << result.system_time << ")"
+        << ", peak memory: " << std::fixed << std::setprecision(2) << (double)result.peak_memory / (1024 * 1024) << " MB"
+        << ", context switches: " << result.voluntary_context_switches << " voluntary, "
+        << result.involuntary_context_switches << " involuntary";
+    if (result.input_bytes >= 1024 * 1024) {
+        out << ", input: " << (double)result.input_bytes / (1024 * 1024) << " MB";
+        if (result.input_time > 0)
+            out << " at " << (double)result.input_bytes / (1024 * 1024) / result.input_time << " MB/s";
+    } else if (result.input_bytes > 0) {
+        out << ", input: " << result.input_bytes << " bytes";
+    }
+    #endif  // _WIN32
+    return out.str();
+}
+
+ProcessResult Process::run(const ProcessOptions &process_options) {
+    Process process(process_options);
+    if (!process.start())
+        return process.result;
+    return process.wait();
+}
+
+}  // namespace comproenv
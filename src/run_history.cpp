@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include "run_history.h"
+#include "statistics.h"
+
+namespace comproenv {
+
+double TestTrend::change() const {
+    if (versions.size() < 2 || versions[versions.size() - 2].median_cpu_time <= 0)
+        return 0;
+    double previous = versions[versions.size() - 2].median_cpu_time;
+    return (versions.back().median_cpu_time - previous) / previous;
+}
+
+RunHistory::RunHistory(const std::string &file_path) : path(file_path), last_runs_path(file_path + ".last") {
+
+}
+
+static void write_record(std::ostream &out, const RunRecord &record) {
+    out << record.timestamp << ' ' << record.version << ' ' << record.verdict << ' ' << record.cpu_time <<
+        ' ' << record.wall_time << ' ' << record.peak_memory << ' ' << record.test << '\n';
+}
+
+// Malformed lines (e.g. written partially) are skipped
+static bool read_records(const std::string &path, const std::function<void(RunRecord &)> &consume) {
+    std::ifstream f(path);
+    if (!f.is_open())
+        return false;
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream in(line);
+        RunRecord record;
+        if (in >> record.timestamp >> record.version >> record.verdict >> record.cpu_time >> record.wall_time >>
+            record.peak_memory && std::getline(in >> std::ws, record.test) && !record.test.empty())
+            consume(record);
+    }
+    return true;
+}
+
+bool RunHistory::append(const std::vector <RunRecord> &records) const {
+    if (records.empty())
+        return true;
+    std::map <std::string, RunRecord> last_runs = load_last_runs();
+    std::ostringstream lines;
+    lines.precision(6);
+    for (const RunRecord &record : records) {
+        write_record(lines, record);
+        last_runs[record.test] = record;
+    }
+    std::ofstream f(path, std::ios::app | std::ios::binary);
+    if (!f.is_open())
+        return false;
+    f << lines.str();
+    if (!f.flush())
+        return false;
+    std::ofstream last(last_runs_path, std::ios::trunc | std::ios::binary);
+    if (!last.is_open())
+        return false;
+    last.precision(6);
+    for (auto &[test, record] : last_runs)
+        write_record(last, record);
+    return (bool)last.flush();
+}
+
+bool RunHistory::load(std::vector <RunRecord> &records) const {
+    records.clear();
+    return read_records(path, [&records](RunRecord &record) { records.push_back(std::move(record)); });
+}
+
+std::map <std::string, RunRecord> RunHistory::load_last_runs() const {
+    std::map <std::string, RunRecord> last_runs;
+    auto consume = [&last_runs](RunRecord &record) { last_runs[record.test] = std::move(record); };
+    // Log that was written before the last runs were stored
+    if (!read_records(last_runs_path, consume))
+        read_records(path, consume);
+    return last_runs;
+}
+
+std::vector <TestTrend> RunHistory::get_trends(const std::vector <RunRecord> &records) {
+    // Versions are ordered by their latest run (records are appended in order of time),
+    // so the current version is compared with the one that was run before it, e.g. after a revert
+    std::map <std::string, size_t> last_record;
+    for (size_t i = 0; i < records.size(); ++i)
+        last_record[records[i].version] = i;
+    std::vector <std::pair <size_t, std::string>> latest;
+    for (auto &[version, index] : last_record)
+        latest.emplace_back(index, version);
+    std::sort(latest.begin(), latest.end());
+    std::map <std::string, size_t> version_order;
+    for (size_t i = 0; i < latest.size(); ++i)
+        version_order[latest[i].second] = i;
+    struct Samples {
+        std::vector <double> cpu_times, wall_times;
+        size_t peak_memory = 0;
+    };
+    std::map <std::string, std::map <size_t, Samples>> samples;
+    for (const RunRecord &record : records) {
+        Samples &test_samples = samples[record.test][version_order[record.version]];
+        if (record.verdict != "OK")
+            continue;
+        test_samples.cpu_times.push_back(record.cpu_time);
+        test_samples.wall_times.push_back(record.wall_time);
+        test_samples.peak_memory = std::max(test_samples.peak_memory, record.peak_memory);
+    }
+    std::vector <std::string> versions(version_order.size());
+    for (auto &[version, order] : version_order)
+        versions[order] = version;
+    std::vector <TestTrend> trends;
+    for (auto &[test, test_samples] : samples) {
+        TestTrend trend;
+        trend.test = test;
+        for (auto &[order, version_samples] : test_samples) {
+            if (version_samples.cpu_times.empty())
+                continue;
+            VersionTiming timing;
+            timing.version = versions[order];
+            timing.runs = version_samples.cpu_times.size();
+            timing.median_cpu_time = SampleStatistics::compute(version_samples.cpu_times).median;
+            timing.median_wall_time = SampleStatistics::compute(version_samples.wall_times).median;
+            timing.peak_memory = version_samples.peak_memory;
+            trend.versions.push_back(timing);
+        }
+        trends.push_back(std::move(trend));
+    }
+    return trends;
+}
+
+}  // namespace comproenv
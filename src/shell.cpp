@@ -14,7 +14,10 @@
 namespace comproenv {
 
 #ifndef _WIN32
-static void sigint_handler([[maybe_unused]] int sig_num) {}
+// Ctrl-C stops running command (e.g. testing of a solution that hangs), not the shell
+static void sigint_handler([[maybe_unused]] int sig_num) {
+    Process::interrupt();
+}
 #endif  // _WIN32
 
 Shell::Shell(const std::string_view config_file_path,
@@ -130,6 +133,166 @@ std::optional <std::string> Shell::get_setting_by_name(const std::string name) {
     }
 }
 
+double Shell::get_number_setting(const std::string name, double default_value) {
+    auto value = get_setting_by_name(name);
+    if (!value.has_value())
+        return default_value;
+    try {
+        size_t length = 0;
+        double result = std::stod(value.value(), &length);
+        if (length == value.value().size() && result >= 0)
+            return result;
+    } catch (std::logic_error &) {}
+    throw std::runtime_error("Incorrect value of setting " + name + ": " + value.value());
+}
+
+std::string Shell::get_helper_command(const std::string &source, std::string &program) {
+    fs::path task_path = fs::path(env_prefix + envs[current_env].get_name()) /
+        (task_prefix + envs[current_env].get_tasks()[current_task].get_name());
+    fs::path source_path = task_path / source;
+    std::string lang = source_path.extension().string();
+    if (!lang.empty())
+        lang.erase(0, 1);
+    std::string name = (task_path / source_path.stem()).string();
+    if (get_setting_by_name("runner_" + lang).has_value()) {
+        std::string command = get_setting_by_name("runner_" + lang).value();
+        replace_all(command, "@name@", name);
+        replace_all(command, "@lang@", lang);
+        program = source_path.string();
+        return command;
+    }
+    #ifdef _WIN32
+    program = name + ".exe";
+    #else
+    program = name;
+    #endif  // _WIN32
+    return "\"" + program + "\"";
+}
+
+std::string Shell::get_runner_command() {
+    fs::path task_path = fs::path(env_prefix + envs[current_env].get_name()) /
+        (task_prefix + envs[current_env].get_tasks()[current_task].get_name());
+    std::string task_name = envs[current_env].get_tasks()[current_task].get_name();
+    std::string lang = envs[current_env].get_tasks()[current_task].get_settings()["language"];
+    std::string command = get_setting_by_name("runner_" + lang).value_or(
+        #ifdef _WIN32
+        (task_path / (task_name + ".exe")).string()
+        #else
+        "./" + (task_path / task_name).string()
+        #endif  // _WIN32
+    );
+    replace_all(command, "@name@", (task_path / task_name).string());
+    replace_all(command, "@lang@", lang);
+    return command;
+}
+
+std::vector <fs::path> Shell::get_tests(const std::vector <std::string> &names) {
+    fs::path tests_path = fs::path(env_prefix + envs[current_env].get_name()) /
+        (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests";
+    std::vector <fs::path> in_files;
+    if (names.empty()) {
+        fs::recursive_directory_iterator it_begin(tests_path), it_end;
+        std::copy_if(it_begin, it_end, std::back_inserter(in_files), [](const fs::path &path) {
+            return fs::is_regular_file(path) && path.extension() == ".in";
+        });
+        std::sort(in_files.begin(), in_files.end());
+    } else {
+        for (const std::string &name : names) {
+            fs::path current_test = tests_path / (name + ".in");
+            if (fs::is_regular_file(current_test)) {
+                in_files.emplace_back(current_test);
+            } else {
+                std::cout << "\033[31mError: Test with name " + name + " is not found\n\033[0m";
+            }
+        }
+    }
+    return in_files;
+}
+
+std::unique_ptr <Checker> Shell::get_checker(std::string &command, std::string &program) {
+    fs::path task_path = fs::path(env_prefix + envs[current_env].get_name()) /
+        (task_prefix + envs[current_env].get_tasks()[current_task].get_name());
+    std::string checker = get_setting_by_name("checker").value_or("tokens");
+    command.clear();
+    program.clear();
+    std::unique_ptr <Checker> result = Checker::create_builtin(checker);
+    if (result)
+        return result;
+    if (checker.compare(0, std::size("plugin:") - 1, "plugin:") == 0) {
+        fs::path source = task_path / checker.substr(std::size("plugin:") - 1);
+        program = (task_path / source.stem()).string() + Checker::get_plugin_extension();
+        if (!fs::is_regular_file(program))
+            throw std::runtime_error("Checker plugin " + program + " is not found, compile it using c command");
+        std::string error;
+        result = Checker::load_plugin(program, error);
+        if (!result)
+            throw std::runtime_error(error);
+        return result;
+    }
+    command = get_helper_command(checker, program);
+    if (!fs::is_regular_file(program))
+        throw std::runtime_error("Checker " + checker + " is not found, compile it using c command");
+    return result;
+}
+
+std::string Shell::get_generator_command() {
+    auto &settings = envs[current_env].get_tasks()[current_task].get_settings();
+    if (settings.find("generator") == settings.end())
+        throw std::runtime_error("There's no generator, create it using cg <language>");
+    std::string lang = settings["generator"];
+    fs::path name = fs::path(env_prefix + envs[current_env].get_name()) /
+        (task_prefix + envs[current_env].get_tasks()[current_task].get_name()) / "tests" / "generator";
+    std::string command;
+    if (get_setting_by_name("runner_" + lang).has_value()) {
+        command = get_setting_by_name("runner_" + lang).value();
+        replace_all(command, "@name@", name.string());
+        replace_all(command, "@lang@", lang);
+        return command;
+    }
+    #ifdef _WIN32
+    fs::path program = name.string() + ".exe";
+    #else
+    fs::path program = name;
+    #endif  // _WIN32
+    if (!fs::is_regular_file(program))
+        throw std::runtime_error("Generator is not compiled, compile it using cg command in generator menu");
+    return "\"" + program.string() + "\"";
+}
+
+StressOptions Shell::get_stress_options(std::unique_ptr <Checker> &checker) {
+    StressOptions options;
+    std::optional <std::string> reference = get_setting_by_name("reference");
+    if (reference.has_value()) {
+        std::string program;
+        options.reference_command = get_helper_command(reference.value(), program);
+        if (!fs::is_regular_file(program))
+            throw std::runtime_error("Reference solution " + reference.value() + " is not found, compile it using c command");
+    }
+    options.solution_command = get_runner_command();
+    options.limits = get_process_limits();
+    std::string checker_program;
+    checker = get_checker(options.checker_command, checker_program);
+    options.checker = checker.get();
+    return options;
+}
+
+ProcessLimits Shell::get_process_limits() {
+    ProcessLimits limits;
+    limits.time_limit = get_number_setting("time_limit", 0);
+    limits.memory_limit = (size_t)(get_number_setting("memory_limit", 0) * 1024 * 1024);
+    limits.output_limit = (size_t)(get_number_setting("output_limit", 0) * 1024 * 1024);
+    return limits;
+}
+
+PreviewOptions Shell::get_preview_options() {
+    PreviewOptions options;
+    options.max_lines = std::stoi(get_setting_by_name("max_lines_count").value_or("100"));
+    options.max_chars = std::stoi(get_setting_by_name("max_chars_count").value_or("-1"));
+    options.tail_lines = (int)get_number_setting("preview_tail_lines", 0);
+    options.max_bytes = std::stoi(get_setting_by_name("preview_max_bytes").value_or("4096"));
+    return options;
+}
+
 void Shell::configure_commands() {
     configure_commands_global();
     configure_commands_environment();
@@ -406,6 +569,7 @@ void Shell::run() {
             std::cout << "Unknown command " << args[0] << '\n';
         } else {
             try {
+                Process::clear_interrupt();
                 int verdict = commands[current_state][args[0]](args);
                 if (verdict) {
                     std::cout << "Command " << args[0] << " returned " << verdict << '\n';
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <thread>
+#include "slow_hunter.h"
+
+namespace comproenv {
+
+std::string HuntCandidate::get_arguments() const {
+    std::string arguments;
+    for (int64_t parameter : parameters)
+        arguments += std::to_string(parameter) + " ";
+    return arguments + std::to_string(seed);
+}
+
+SlowHunter::SlowHunter(const StressOptions &stress_options, const HuntOptions &hunt_options) :
+    tester(stress_options), options(hunt_options) {}
+
+SlowHunter::Result SlowHunter::run(uint64_t seed, size_t evaluations, unsigned jobs,
+                                   const std::function<void(size_t, double)> &progress) const {
+    Result result;
+    std::mt19937_64 rng(seed);
+    if (jobs == 0)
+        jobs = TestRunner::default_jobs();
+    // Population is wider than the kept inputs, so that the search does not stick to one of them
+    size_t population_size = std::max<size_t>(options.keep, 2 * jobs);
+    std::vector <HuntCandidate> population;
+    std::set <std::string> evaluated;
+    bool counted_instructions = options.instructions;
+
+    auto random_candidate = [&]() {
+        HuntCandidate candidate;
+        for (auto [low, high] : options.parameters)
+            candidate.parameters.push_back(std::uniform_int_distribution <int64_t>(low, high)(rng));
+        candidate.seed = rng();
+        return candidate;
+    };
+    auto mutate = [&](HuntCandidate candidate) {
+        std::uniform_real_distribution <double> probability(0, 1);
+        if (candidate.parameters.empty() || probability(rng) < 0.5)
+            candidate.seed = rng();
+        if (candidate.parameters.empty())
+            return candidate;
+        size_t mutated = std::uniform_int_distribution <size_t>(0, candidate.parameters.size() - 1)(rng);
+        for (size_t i = 0; i < candidate.parameters.size(); ++i) {
+            if (i != mutated && probability(rng) >= 1.0 / (double)candidate.parameters.size())
+                continue;
+            auto [low, high] = options.parameters[i];
+            int64_t &parameter = candidate.parameters[i];
+            double choice = probability(rng);
+            if (choice < 0.15) {
+                // Extreme values are often the worst cases
+                parameter = probability(rng) < 0.5 ? low : high;
+            } else {
+                // Computed in double, so that wide ranges do not overflow, and clamped before conversion
+                double span = (double)high - (double)low;
+                double moved = (double)parameter + std::normal_distribution <double>(0, 0.1 * span + 1)(rng);
+                if (moved >= (double)high)
+                    parameter = high;
+                else if (moved <= (double)low)
+                    parameter = low;
+                else
+                    parameter = (int64_t)moved;
+            }
+        }
+        return candidate;
+    };
+    auto select_parent = [&]() -> const HuntCandidate & {
+        std::uniform_int_distribution <size_t> index(0, population.size() - 1);
+        const HuntCandidate &a = population[index(rng)], &b = population[index(rng)];
+        return a.fitness >= b.fitness ? a : b;
+    };
+
+    while (result.evaluations < evaluations && result.error.empty()) {
+        std::vector <HuntCandidate> batch;
+        size_t batch_size = std::min<size_t>(jobs, evaluations - result.evaluations);
+        for (size_t attempt = 0; batch.size() < batch_size && attempt < 100 * batch_size; ++attempt) {
+            bool explore = population.size() < population_size ||
+                std::uniform_real_distribution <double>(0, 1)(rng) < 0.2;
+            HuntCandidate candidate = explore ? random_candidate() : mutate(select_parent());
+            if (evaluated.insert(candidate.get_arguments()).second)
+                batch.push_back(std::move(candidate));
+        }
+        if (batch.empty())
+            break;
+        std::vector <std::string> errors(batch.size());
+        std::vector <std::thread> workers;
+        for (size_t i = 0; i < batch.size(); ++i)
+            workers.emplace_back([this, &batch, &errors, i]() {
+                OutputCapture input;
+                if (tester.generate(batch[i].get_arguments(), input, errors[i]))
+                    batch[i].test = tester.check(input);
+            });
+        for (auto &thread : workers)
+            thread.join();
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (!errors[i].empty()) {
+                result.error = errors[i];
+                break;
+            }
+            ++result.evaluations;
+            HuntCandidate &candidate = batch[i];
+            TestRunner::Verdict verdict = candidate.test.verdict;
+            if (verdict != TestRunner::Verdict::OK && verdict != TestRunner::Verdict::TIME_LIMIT_EXCEEDED) {
+                ++result.failures;
+                continue;
+            }
+            long long instructions = candidate.test.solution.perf_counts.values[PerfCounts::INSTRUCTIONS];
+            // All candidates are compared by the same measure
+            if (counted_instructions && instructions < 0)
+                counted_instructions = false;
+            candidate.fitness = counted_instructions ? (double)instructions : candidate.test.solution.cpu_time;
+            population.push_back(std::move(candidate));
+        }
+        if (!counted_instructions)
+            for (HuntCandidate &candidate : population)
+                candidate.fitness = candidate.test.solution.cpu_time;
+        std::stable_sort(population.begin(), population.end(), [](const HuntCandidate &a, const HuntCandidate &b) {
+            return a.fitness > b.fitness;
+        });
+        if (population.size() > population_size)
+            population.resize(population_size);
+        progress(result.evaluations, population.empty() ? 0 : population.front().test.solution.cpu_time);
+    }
+    result.instructions = counted_instructions;
+    if (population.size() > options.keep)
+        population.resize(options.keep);
+    result.slowest = std::move(population);
+    return result;
+}
+
+}  // namespace comproenv
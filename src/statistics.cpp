@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <cmath>
+#include "statistics.h"
+
+namespace comproenv {
+
+double SampleStatistics::variation() const {
+    return mean > 0 ? stddev / mean : 0;
+}
+
+SampleStatistics SampleStatistics::compute(std::vector <double> values) {
+    SampleStatistics result;
+    if (values.empty())
+        return result;
+    std::sort(values.begin(), values.end());
+    result.count = values.size();
+    result.min = values.front();
+    result.max = values.back();
+    result.median = quantile(values, 0.5);
+    result.p95 = quantile(values, 0.95);
+    double sum = 0;
+    for (double value : values)
+        sum += value;
+    result.mean = sum / (double)values.size();
+    if (values.size() > 1) {
+        double squares = 0;
+        for (double value : values)
+            squares += (value - result.mean) * (value - result.mean);
+        result.stddev = std::sqrt(squares / (double)(values.size() - 1));
+    }
+    return result;
+}
+
+double SampleStatistics::quantile(const std::vector <double> &sorted_values, double q) {
+    if (sorted_values.empty())
+        return 0;
+    double position = q * (double)(sorted_values.size() - 1);
+    size_t lower = (size_t)position;
+    if (lower + 1 >= sorted_values.size())
+        return sorted_values.back();
+    double fraction = position - (double)lower;
+    return sorted_values[lower] + (sorted_values[lower + 1] - sorted_values[lower]) * fraction;
+}
+
+}  // namespace comproenv
@@ -0,0 +1,196 @@
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "stress.h"
+
+namespace comproenv {
+
+StressTester::StressTester(const StressOptions &stress_options) : options(stress_options) {}
+
+static std::string describe_exit(const ProcessResult &result) {
+    if (!result.launched)
+        return result.error;
+    return "exit code " + std::to_string(result.exit_code) +
+        (result.possibly_out_of_memory ? " (possibly out of memory)" : "");
+}
+
+bool StressTester::generate(uint64_t seed, const OutputCapture &input, std::string &error) const {
+    return generate(std::to_string(seed), input, error);
+}
+
+bool StressTester::generate(const std::string &arguments, const OutputCapture &input, std::string &error) const {
+    ProcessOptions generator_options;
+    generator_options.command = options.generator_command + " " + arguments;
+    generator_options.stdout_capture = &input;
+    ProcessResult result = Process::run(generator_options);
+    if (!result.launched || result.exit_code != 0) {
+        error = "Generator failed with arguments " + arguments + ": " + describe_exit(result);
+        return false;
+    }
+    return true;
+}
+
+StressCase StressTester::check(const OutputCapture &input) const {
+    StressCase result;
+    OutputCapture answer;
+    std::optional <OutputCapture> errors;
+    if (options.capture_stderr)
+        errors.emplace();
+    const OutputCapture *stderr_capture = errors.has_value() ? &errors.value() : nullptr;
+    if (!options.reference_command.empty()) {
+        ProcessOptions reference_options;
+        reference_options.command = options.reference_command;
+        reference_options.stdin_path = input.get_path();
+        reference_options.stdout_capture = &answer;
+        reference_options.stderr_capture = stderr_capture;
+        ProcessResult reference = Process::run(reference_options);
+        if (!reference.launched || reference.exit_code != 0) {
+            result.valid = false;
+            result.message = "Reference solution failed: " + describe_exit(reference);
+            return result;
+        }
+    }
+    OutputCapture output;
+    ProcessOptions solution_options;
+    solution_options.command = options.solution_command;
+    solution_options.stdin_path = input.get_path();
+    solution_options.stdout_capture = &output;
+    solution_options.stderr_capture = stderr_capture;
+    solution_options.limits = options.limits;
+    solution_options.perf_counters = options.perf_counters;
+    result.solution = Process::run(solution_options);
+    const ProcessResult &solution = result.solution;
+    if (!solution.launched) {
+        result.verdict = TestRunner::Verdict::RUNTIME_ERROR;
+        result.message = solution.error;
+    } else if (solution.exceeded_limit == ProcessResult::Limit::TIME) {
+        result.verdict = TestRunner::Verdict::TIME_LIMIT_EXCEEDED;
+    } else if (solution.exceeded_limit == ProcessResult::Limit::MEMORY) {
+        result.verdict = TestRunner::Verdict::MEMORY_LIMIT_EXCEEDED;
+    } else if (solution.exceeded_limit == ProcessResult::Limit::OUTPUT) {
+        result.verdict = TestRunner::Verdict::OUTPUT_LIMIT_EXCEEDED;
+    } else if (solution.exit_code != 0) {
+        result.verdict = TestRunner::Verdict::RUNTIME_ERROR;
+        result.message = describe_exit(solution);
+    } else if (!options.reference_command.empty()) {
+        int code;
+        if (options.checker) {
+            MappedFile input_file(input.get_path()), output_file(output.get_path()), answer_file(answer.get_path());
+            Checker::Result check = options.checker->check(input_file.get_buffer(), output_file.get_buffer(),
+                                                           answer_file.get_buffer());
+            code = check.verdict;
+            result.message = check.message;
+        } else {
+            OutputCapture checker_output;
+            ProcessOptions checker_options;
+            checker_options.command = options.checker_command + " \"" + input.get_path() + "\" \"" +
+                output.get_path() + "\" \"" + answer.get_path() + "\"";
+            checker_options.stdout_capture = &checker_output;
+            checker_options.stderr_capture = &checker_output;
+            ProcessResult checker = Process::run(checker_options);
+            code = checker.launched ? checker.exit_code : COMPROENV_FAIL;
+            result.message = checker.launched ? read_capture(checker_output) : checker.error;
+            while (!result.message.empty() && std::isspace((unsigned char)result.message.back()))
+                result.message.pop_back();
+        }
+        if (code == COMPROENV_WRONG_ANSWER)
+            result.verdict = TestRunner::Verdict::MISMATCH;
+        else if (code == COMPROENV_PRESENTATION_ERROR)
+            result.verdict = TestRunner::Verdict::PRESENTATION_ERROR;
+        else if (code != COMPROENV_OK)
+            result.verdict = TestRunner::Verdict::CHECKER_FAILED;
+    }
+    if (result.verdict != TestRunner::Verdict::OK) {
+        result.input = read_capture(input);
+        result.answer = read_capture(answer);
+        result.output = read_capture(output);
+        if (errors.has_value())
+            result.errors = read_capture(errors.value());
+    }
+    return result;
+}
+
+StressCase StressTester::check(const std::string &input) const {
+    OutputCapture input_file;
+    {
+        std::ofstream f(input_file.get_path(), std::ios::binary);
+        f.write(input.data(), (std::streamsize)input.size());
+    }
+    return check(input_file);
+}
+
+StressTester::Result StressTester::run(uint64_t first_seed, size_t iterations, unsigned jobs,
+                                       const std::function<void(size_t)> &progress) const {
+    Result result;
+    std::atomic <size_t> next_iteration(0);
+    std::atomic <size_t> finished_iterations(0);
+    std::atomic <bool> stop(false);
+    std::mutex result_mutex;
+    std::condition_variable workers_finished;
+    size_t running_workers = 0;
+
+    auto worker = [&]() {
+        size_t iteration;
+        while (!stop && (iteration = next_iteration++) < iterations) {
+            uint64_t seed = first_seed + iteration;
+            OutputCapture input;
+            std::string error;
+            std::optional <StressCase> test;
+            if (generate(seed, input, error)) {
+                test = check(input);
+                if (!test->valid)
+                    error = test->message + " (seed " + std::to_string(seed) + ")";
+            }
+            if (!error.empty()) {
+                std::lock_guard <std::mutex> lock(result_mutex);
+                if (result.error.empty())
+                    result.error = error;
+                stop = true;
+            } else if (test->verdict != TestRunner::Verdict::OK) {
+                std::lock_guard <std::mutex> lock(result_mutex);
+                // Tests are finished out of order, the one with the smallest seed is reported
+                if (!result.failure.has_value() || seed < result.seed) {
+                    result.failure = std::move(test);
+                    result.seed = seed;
+                }
+                stop = true;
+            }
+            ++finished_iterations;
+        }
+        std::lock_guard <std::mutex> lock(result_mutex);
+        --running_workers;
+        workers_finished.notify_one();
+    };
+
+    std::vector <std::thread> workers;
+    size_t workers_count = std::min<size_t>(jobs == 0 ? TestRunner::default_jobs() : jobs, iterations);
+    running_workers = workers_count;
+    for (size_t i = 0; i < workers_count; ++i)
+        workers.emplace_back(worker);
+    {
+        std::unique_lock <std::mutex> lock(result_mutex);
+        while (!workers_finished.wait_for(lock, std::chrono::milliseconds(250),
+                                          [&]() { return running_workers == 0; })) {
+            lock.unlock();
+            progress(finished_iterations);
+            lock.lock();
+        }
+    }
+    for (auto &thread : workers)
+        thread.join();
+    result.iterations = finished_iterations;
+    return result;
+}
+
+std::string StressTester::read_capture(const OutputCapture &capture) {
+    std::ifstream f(capture.get_path(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+}  // namespace comproenv
@@ -0,0 +1,52 @@
+#include <fstream>
+#include "test_cache.h"
+
+namespace comproenv {
+
+TestCache::TestCache(const std::string &file_path) : path(file_path), modified(false) {
+
+}
+
+bool TestCache::load() {
+    entries.clear();
+    modified = false;
+    std::ifstream f(path);
+    if (!f.is_open())
+        return false;
+    std::string key, name;
+    while (f >> key && std::getline(f >> std::ws, name))
+        entries[name] = key;
+    return true;
+}
+
+bool TestCache::save() {
+    if (!modified)
+        return true;
+    std::ofstream f(path, std::ios::trunc);
+    if (!f.is_open())
+        return false;
+    for (auto &[name, key] : entries)
+        f << key << ' ' << name << '\n';
+    modified = false;
+    return true;
+}
+
+bool TestCache::contains(const std::string &test_name, const std::string &key) const {
+    auto it = entries.find(test_name);
+    return it != entries.end() && it->second == key;
+}
+
+void TestCache::store(const std::string &test_name, const std::string &key) {
+    auto it = entries.find(test_name);
+    if (it != entries.end() && it->second == key)
+        return;
+    entries[test_name] = key;
+    modified = true;
+}
+
+void TestCache::erase(const std::string &test_name) {
+    if (entries.erase(test_name))
+        modified = true;
+}
+
+}  // namespace comproenv
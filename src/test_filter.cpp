@@ -0,0 +1,97 @@
+#include <stdexcept>
+#include "hash.h"
+#include "test_filter.h"
+
+namespace comproenv {
+
+void TestFilter::add_glob(const std::string &pattern) {
+    globs.push_back(pattern);
+}
+
+void TestFilter::set_regex(const std::string &pattern) {
+    regex.emplace(pattern, std::regex::ECMAScript | std::regex::optimize);
+}
+
+void TestFilter::set_shard(const std::string &shard_description) {
+    size_t slash = shard_description.find('/');
+    if (slash == std::string::npos || slash == 0)
+        throw std::invalid_argument("Incorrect shard " + shard_description);
+    size_t index_length = 0, count_length = 0;
+    unsigned long long index = std::stoull(shard_description.substr(0, slash), &index_length);
+    unsigned long long count = std::stoull(shard_description.substr(slash + 1), &count_length);
+    if (index_length != slash || count_length != shard_description.size() - slash - 1 ||
+        index == 0 || index > count)
+        throw std::invalid_argument("Incorrect shard " + shard_description);
+    shard = (size_t)index - 1;
+    shards_count = (size_t)count;
+}
+
+bool TestFilter::empty() const {
+    return globs.empty() && !regex.has_value() && shards_count == 1;
+}
+
+bool TestFilter::matches(const std::string &test_name) const {
+    if (!globs.empty()) {
+        bool matched = false;
+        for (const std::string &glob : globs)
+            if ((matched = match_glob(glob, test_name)))
+                break;
+        if (!matched)
+            return false;
+    }
+    if (regex.has_value() && !std::regex_search(test_name, regex.value()))
+        return false;
+    return shards_count == 1 || Hasher().update(test_name).digest() % shards_count == shard;
+}
+
+bool TestFilter::match_glob(const std::string &pattern, const std::string &name) {
+    // Greedy matching with backtracking to the last star, linear for patterns without sets
+    size_t p = 0, n = 0;
+    size_t star = std::string::npos, star_name = 0;
+    auto match_char = [&pattern](size_t &position, char c) {
+        if (pattern[position] == '?') {
+            ++position;
+            return true;
+        }
+        if (pattern[position] != '[') {
+            return pattern[position++] == c;
+        }
+        size_t end = pattern.find(']', position + 2);
+        if (end == std::string::npos)
+            return pattern[position++] == c;
+        bool negated = pattern[position + 1] == '!' || pattern[position + 1] == '^';
+        bool found = false;
+        for (size_t i = position + 1 + negated; i < end; ++i) {
+            if (i + 2 < end && pattern[i + 1] == '-') {
+                found = found || (pattern[i] <= c && c <= pattern[i + 2]);
+                i += 2;
+            } else {
+                found = found || pattern[i] == c;
+            }
+        }
+        position = end + 1;
+        return found != negated;
+    };
+    while (n < name.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_name = n;
+            continue;
+        }
+        size_t next = p;
+        if (p < pattern.size() && match_char(next, name[n])) {
+            p = next;
+            ++n;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            n = ++star_name;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*')
+        ++p;
+    return p == pattern.size();
+}
+
+}  // namespace comproenv
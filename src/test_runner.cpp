@@ -0,0 +1,127 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <optional>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include "test_runner.h"
+
+namespace comproenv {
+
+TestRunner::TestRunner(unsigned jobs_count) : jobs(jobs_count) {
+    if (jobs == 0)
+        jobs = default_jobs();
+}
+
+unsigned TestRunner::default_jobs() {
+    unsigned concurrency = std::thread::hardware_concurrency();
+    return concurrency == 0 ? 1 : concurrency;
+}
+
+std::string TestRunner::get_verdict_name(Verdict verdict) {
+    switch (verdict) {
+    case Verdict::OK:
+        return "OK";
+    case Verdict::RUNTIME_ERROR:
+        return "RE";
+    case Verdict::MISMATCH:
+        return "WA";
+    case Verdict::TIME_LIMIT_EXCEEDED:
+        return "TLE";
+    case Verdict::MEMORY_LIMIT_EXCEEDED:
+        return "MLE";
+    case Verdict::OUTPUT_LIMIT_EXCEEDED:
+        return "OLE";
+    case Verdict::PRESENTATION_ERROR:
+        return "PE";
+    case Verdict::CHECKER_FAILED:
+        return "FAIL";
+    }
+    return "";
+}
+
+unsigned TestRunner::get_jobs() const {
+    return jobs;
+}
+
+void TestRunner::set_order(const std::vector <size_t> &test_order) {
+    order = test_order;
+}
+
+void TestRunner::run(size_t tests_count,
+                     const std::function<Result(size_t)> &run_test,
+                     const std::function<void(size_t, Result &)> &on_result) const {
+    run_until(tests_count, [&run_test](size_t index, const std::atomic <bool> &) {
+        return run_test(index);
+    }, [](const Result &) {
+        return false;
+    }, on_result);
+}
+
+size_t TestRunner::run_until(size_t tests_count,
+                             const std::function<Result(size_t, const std::atomic <bool> &)> &run_test,
+                             const std::function<bool(const Result &)> &is_last,
+                             const std::function<void(size_t, Result &)> &on_result) const {
+    if (!order.empty() && order.size() != tests_count)
+        throw std::invalid_argument("Order of tests does not match number of tests");
+    std::vector <std::optional <Result>> results(tests_count);
+    std::unique_ptr <std::atomic <bool>[]> cancelled(new std::atomic <bool>[tests_count]);
+    for (size_t i = 0; i < tests_count; ++i)
+        cancelled[i] = false;
+    std::atomic <size_t> next_test(0);
+    // Index of the first test after which testing stops
+    std::atomic <size_t> last_test(tests_count);
+    std::mutex results_mutex;
+    std::condition_variable result_ready;
+
+    auto worker = [&]() {
+        size_t position;
+        while ((position = next_test++) < tests_count) {
+            size_t index = order.empty() ? position : order[position];
+            if (index > last_test)
+                continue;
+            Result result;
+            try {
+                result = run_test(index, cancelled[index]);
+            } catch (std::exception &e) {
+                result.verdict = Verdict::RUNTIME_ERROR;
+                result.report += std::string("Error: ") + e.what() + '\n';
+            }
+            if (index < last_test && is_last(result)) {
+                std::lock_guard <std::mutex> lock(results_mutex);
+                if (index < last_test) {
+                    last_test = index;
+                    for (size_t i = index + 1; i < tests_count; ++i)
+                        cancelled[i] = true;
+                }
+            }
+            std::lock_guard <std::mutex> lock(results_mutex);
+            results[index] = std::move(result);
+            result_ready.notify_one();
+        }
+    };
+
+    std::vector <std::thread> workers;
+    size_t workers_count = std::min<size_t>(jobs, tests_count);
+    for (size_t i = 0; i < workers_count; ++i)
+        workers.emplace_back(worker);
+
+    // Report finished tests as soon as all previous ones are reported
+    size_t reported = 0;
+    while (reported < tests_count && reported <= last_test) {
+        std::unique_lock <std::mutex> lock(results_mutex);
+        result_ready.wait(lock, [&]() { return results[reported].has_value(); });
+        Result result = std::move(*results[reported]);
+        results[reported].reset();
+        lock.unlock();
+        on_result(reported++, result);
+    }
+
+    for (auto &thread : workers)
+        thread.join();
+    return reported;
+}
+
+}  // namespace comproenv